@@ -0,0 +1,274 @@
+#pragma once
+
+#include "Json.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// One bench step, runs from every input file with the same suite, name and size are pooled
+struct BenchEntry
+{
+	std::string suite; // ss-view and ss-export both time steps such as Project::Load
+	std::string name;
+	std::string size;
+	std::vector<double> runsMs;
+	std::vector<double> allocations;
+	std::vector<double> bytes;
+	std::vector<double> peakRssKb;
+};
+
+struct Thresholds
+{
+	double time = 0.10; // Relative, the noise of the runs can widen it
+	double timeFloorMs = 0.5; // Changes smaller than this are never reported
+	double noiseFactor = 3.0; // Multiples of the relative median absolute deviation
+	double allocations = 0.02;
+	double bytes = 0.05;
+	double rss = 0.15;
+	double rssFloorKb = 2048.0;
+};
+
+struct MetricResult
+{
+	std::string metric;
+	double baseline = 0.0;
+	double current = 0.0;
+	double tolerance = 0.0; // Relative
+	bool isRegression = false;
+	bool isImprovement = false;
+};
+
+struct EntryResult
+{
+	std::string suite;
+	std::string name;
+	std::string size;
+	bool isMissing = false; // In the baseline but not in the current results
+	bool isNew = false;
+	std::vector<MetricResult> metrics;
+};
+
+class Comparator
+{
+public:
+	Comparator(const Thresholds& thresholds) : m_thresholds(thresholds) {}
+
+	// Appends to 'entries', false -> 'error' says why
+	static bool LoadResults(const std::filesystem::path& path, std::vector<BenchEntry>& entries, std::string& error)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			error = path.string() + " -- could not be opened";
+			return false;
+		}
+
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+
+		JsonValue root;
+		JsonParser parser;
+		if (!parser.Parse(buffer.str(), root))
+		{
+			error = path.string() + " -- " + parser.GetError();
+			return false;
+		}
+
+		const JsonValue* results = root.Find("results");
+		if (results == nullptr || results->type != JsonValue::Type::Array)
+		{
+			error = path.string() + " -- has no results array";
+			return false;
+		}
+
+		std::string suite = root.StringOr("suite", "");
+		for (const JsonValue& result : results->array)
+		{
+			std::string name = result.StringOr("name", "");
+			std::string size = result.StringOr("size", "");
+			if (name.empty())
+				continue;
+
+			auto entry = std::find_if(entries.begin(), entries.end(), [&](const BenchEntry& e) { return e.suite == suite && e.name == name && e.size == size; });
+			if (entry == entries.end())
+			{
+				entry = entries.emplace(entries.end());
+				entry->suite = suite;
+				entry->name = name;
+				entry->size = size;
+			}
+
+			const JsonValue* runs = result.Find("runsMs");
+			if (runs != nullptr && runs->type == JsonValue::Type::Array && !runs->array.empty())
+			{
+				for (const JsonValue& run : runs->array)
+					entry->runsMs.push_back(run.number);
+			}
+			else
+			{
+				entry->runsMs.push_back(result.NumberOr("ms", 0.0));
+			}
+
+			entry->allocations.push_back(result.NumberOr("allocations", 0.0));
+			entry->bytes.push_back(result.NumberOr("bytes", 0.0));
+			entry->peakRssKb.push_back(result.NumberOr("peakRssKb", 0.0));
+		}
+		return true;
+	}
+
+	// In baseline order, new entries last
+	std::vector<EntryResult> Compare(const std::vector<BenchEntry>& baseline, const std::vector<BenchEntry>& current) const
+	{
+		std::vector<EntryResult> results;
+		for (const BenchEntry& base : baseline)
+		{
+			EntryResult result;
+			result.suite = base.suite;
+			result.name = base.name;
+			result.size = base.size;
+
+			auto curr = std::find_if(current.begin(), current.end(), [&](const BenchEntry& e) { return IsSameStep(e, base); });
+			if (curr == current.end())
+			{
+				result.isMissing = true;
+				results.push_back(result);
+				continue;
+			}
+
+			double timeTolerance = std::max({ m_thresholds.time,
+				m_thresholds.noiseFactor * RelativeDeviation(base.runsMs),
+				m_thresholds.noiseFactor * RelativeDeviation(curr->runsMs) });
+
+			result.metrics.push_back(Check("ms", Median(base.runsMs), Median(curr->runsMs), timeTolerance, m_thresholds.timeFloorMs));
+			result.metrics.push_back(Check("allocations", Median(base.allocations), Median(curr->allocations), m_thresholds.allocations, 0.0));
+			result.metrics.push_back(Check("bytes", Median(base.bytes), Median(curr->bytes), m_thresholds.bytes, 0.0));
+			result.metrics.push_back(Check("peakRssKb", Median(base.peakRssKb), Median(curr->peakRssKb), m_thresholds.rss, m_thresholds.rssFloorKb));
+			results.push_back(result);
+		}
+
+		for (const BenchEntry& curr : current)
+		{
+			auto base = std::find_if(baseline.begin(), baseline.end(), [&](const BenchEntry& e) { return IsSameStep(e, curr); });
+			if (base != baseline.end())
+				continue;
+
+			EntryResult result;
+			result.suite = curr.suite;
+			result.name = curr.name;
+			result.size = curr.size;
+			result.isNew = true;
+			results.push_back(result);
+		}
+		return results;
+	}
+
+	static std::string Report(const std::vector<EntryResult>& results, bool verbose)
+	{
+		std::stringstream out;
+		out << std::fixed << std::setprecision(2);
+
+		size_t regressions = 0;
+		size_t improvements = 0;
+		size_t missing = 0;
+		for (const EntryResult& result : results)
+		{
+			std::string label = ((result.suite.empty()) ? "" : result.suite + ": ") + result.name + " (" + result.size + ")";
+			if (result.isMissing)
+			{
+				++missing;
+				out << "MISSING     " << label << "\n";
+				continue;
+			}
+			if (result.isNew)
+			{
+				if (verbose)
+					out << "NEW         " << label << "\n";
+				continue;
+			}
+
+			for (const MetricResult& metric : result.metrics)
+			{
+				regressions += (metric.isRegression) ? 1 : 0;
+				improvements += (metric.isImprovement) ? 1 : 0;
+				if (!verbose && !metric.isRegression && !metric.isImprovement)
+					continue;
+
+				const char* status = (metric.isRegression) ? "REGRESSION  " : (metric.isImprovement) ? "improvement " : "ok          ";
+				double change = (metric.baseline != 0.0) ? (metric.current - metric.baseline) / metric.baseline * 100.0 : 0.0;
+				out << status << label << " " << metric.metric << ": " << metric.baseline << " -> " << metric.current
+					<< " (" << ((change >= 0.0) ? "+" : "") << change << "%, tolerance " << metric.tolerance * 100.0 << "%)\n";
+			}
+		}
+
+		out << "\n" << regressions << " regressions, " << improvements << " improvements, " << missing << " missing\n";
+		return out.str();
+	}
+
+	static bool HasFailures(const std::vector<EntryResult>& results)
+	{
+		for (const EntryResult& result : results)
+		{
+			if (result.isMissing)
+				return true;
+
+			for (const MetricResult& metric : result.metrics)
+			{
+				if (metric.isRegression)
+					return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	static bool IsSameStep(const BenchEntry& a, const BenchEntry& b)
+	{
+		return a.suite == b.suite && a.name == b.name && a.size == b.size;
+	}
+
+	static MetricResult Check(const std::string& name, double baseline, double current, double tolerance, double floor)
+	{
+		MetricResult result;
+		result.metric = name;
+		result.baseline = baseline;
+		result.current = current;
+		result.tolerance = tolerance;
+
+		double allowed = std::max(baseline * tolerance, floor);
+		result.isRegression = current - baseline > allowed;
+		result.isImprovement = baseline - current > allowed;
+		return result;
+	}
+
+	static double Median(std::vector<double> values)
+	{
+		if (values.empty())
+			return 0.0;
+
+		std::sort(values.begin(), values.end());
+		size_t mid = values.size() / 2;
+		return (values.size() % 2 == 1) ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+	}
+
+	// Median absolute deviation over the median, robust against the odd slow run
+	static double RelativeDeviation(const std::vector<double>& values)
+	{
+		double median = Median(values);
+		if (values.size() < 3 || median <= 0.0)
+			return 0.0;
+
+		std::vector<double> deviations;
+		for (double value : values)
+			deviations.push_back(std::abs(value - median));
+
+		return Median(deviations) / median;
+	}
+
+	Thresholds m_thresholds;
+};
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Just enough JSON to read the bench output back. No unicode escapes beyond passing them through.
+struct JsonValue
+{
+	enum class Type
+	{
+		Null,
+		Bool,
+		Number,
+		String,
+		Array,
+		Object
+	};
+
+	Type type = Type::Null;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> array;
+	std::vector<std::pair<std::string, JsonValue>> object;
+
+	const JsonValue* Find(const std::string& key) const
+	{
+		for (const auto& pair : object)
+		{
+			if (pair.first == key)
+				return &pair.second;
+		}
+		return nullptr;
+	}
+
+	double NumberOr(const std::string& key, double fallback) const
+	{
+		const JsonValue* value = Find(key);
+		return (value != nullptr && value->type == Type::Number) ? value->number : fallback;
+	}
+
+	std::string StringOr(const std::string& key, const std::string& fallback) const
+	{
+		const JsonValue* value = Find(key);
+		return (value != nullptr && value->type == Type::String) ? value->string : fallback;
+	}
+};
+
+class JsonParser
+{
+public:
+	// false -> GetError() says where it stopped
+	bool Parse(const std::string& text, JsonValue& out)
+	{
+		m_text = &text;
+		m_pos = 0;
+		m_error.clear();
+
+		if (!ParseValue(out))
+			return false;
+
+		SkipWhitespace();
+		if (m_pos != text.length())
+			return Fail("trailing characters");
+
+		return true;
+	}
+
+	const std::string& GetError() const { return m_error; }
+
+private:
+	bool ParseValue(JsonValue& out)
+	{
+		SkipWhitespace();
+		if (m_pos >= m_text->length())
+			return Fail("unexpected end");
+
+		char c = (*m_text)[m_pos];
+		if (c == '{')
+			return ParseObject(out);
+		if (c == '[')
+			return ParseArray(out);
+		if (c == '"')
+		{
+			out.type = JsonValue::Type::String;
+			return ParseString(out.string);
+		}
+		if (Consume("true"))
+		{
+			out.type = JsonValue::Type::Bool;
+			out.boolean = true;
+			return true;
+		}
+		if (Consume("false"))
+		{
+			out.type = JsonValue::Type::Bool;
+			return true;
+		}
+		if (Consume("null"))
+		{
+			out.type = JsonValue::Type::Null;
+			return true;
+		}
+		return ParseNumber(out);
+	}
+
+	bool ParseObject(JsonValue& out)
+	{
+		out.type = JsonValue::Type::Object;
+		++m_pos;
+		SkipWhitespace();
+		if (Peek('}'))
+		{
+			++m_pos;
+			return true;
+		}
+
+		while (true)
+		{
+			SkipWhitespace();
+			std::string key;
+			if (!Peek('"') || !ParseString(key))
+				return Fail("expected a key");
+
+			SkipWhitespace();
+			if (!Peek(':'))
+				return Fail("expected ':'");
+			++m_pos;
+
+			out.object.emplace_back(key, JsonValue());
+			if (!ParseValue(out.object.back().second))
+				return false;
+
+			SkipWhitespace();
+			if (Peek(','))
+			{
+				++m_pos;
+				continue;
+			}
+			if (Peek('}'))
+			{
+				++m_pos;
+				return true;
+			}
+			return Fail("expected ',' or '}'");
+		}
+	}
+
+	bool ParseArray(JsonValue& out)
+	{
+		out.type = JsonValue::Type::Array;
+		++m_pos;
+		SkipWhitespace();
+		if (Peek(']'))
+		{
+			++m_pos;
+			return true;
+		}
+
+		while (true)
+		{
+			out.array.emplace_back();
+			if (!ParseValue(out.array.back()))
+				return false;
+
+			SkipWhitespace();
+			if (Peek(','))
+			{
+				++m_pos;
+				continue;
+			}
+			if (Peek(']'))
+			{
+				++m_pos;
+				return true;
+			}
+			return Fail("expected ',' or ']'");
+		}
+	}
+
+	bool ParseString(std::string& out)
+	{
+		++m_pos;
+		while (m_pos < m_text->length())
+		{
+			char c = (*m_text)[m_pos++];
+			if (c == '"')
+				return true;
+
+			if (c != '\\')
+			{
+				out.push_back(c);
+				continue;
+			}
+
+			if (m_pos >= m_text->length())
+				break;
+
+			char escaped = (*m_text)[m_pos++];
+			switch (escaped)
+			{
+			case 'n': out.push_back('\n'); break;
+			case 't': out.push_back('\t'); break;
+			case 'r': out.push_back('\r'); break;
+			case 'b': out.push_back('\b'); break;
+			case 'f': out.push_back('\f'); break;
+			case 'u': out.append("\\u"); break;
+			default: out.push_back(escaped); break;
+			}
+		}
+		return Fail("unterminated string");
+	}
+
+	bool ParseNumber(JsonValue& out)
+	{
+		const char* start = m_text->c_str() + m_pos;
+		char* end = nullptr;
+		out.number = std::strtod(start, &end);
+		if (end == start)
+			return Fail("unexpected character");
+
+		out.type = JsonValue::Type::Number;
+		m_pos += end - start;
+		return true;
+	}
+
+	void SkipWhitespace()
+	{
+		while (m_pos < m_text->length() && ((*m_text)[m_pos] == ' ' || (*m_text)[m_pos] == '\t' || (*m_text)[m_pos] == '\n' || (*m_text)[m_pos] == '\r'))
+			++m_pos;
+	}
+
+	bool Peek(char c) const { return m_pos < m_text->length() && (*m_text)[m_pos] == c; }
+
+	bool Consume(const char* word)
+	{
+		size_t length = std::char_traits<char>::length(word);
+		if (m_text->compare(m_pos, length, word) != 0)
+			return false;
+
+		m_pos += length;
+		return true;
+	}
+
+	bool Fail(const std::string& reason)
+	{
+		m_error = reason + " at offset " + std::to_string(m_pos);
+		return false;
+	}
+
+	const std::string* m_text = nullptr;
+	size_t m_pos = 0;
+	std::string m_error;
+};
@@ -0,0 +1,132 @@
+#include <iostream>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Comparator.h"
+
+// std::stod throws on text, and a negative or infinite threshold would make every comparison meaningless
+static bool ParseThreshold(const char* str, double& value)
+{
+    char* end = nullptr;
+    double parsed = std::strtod(str, &end);
+    if (end == str || *end != '\0' || !std::isfinite(parsed) || parsed < 0.0)
+        return false;
+
+    value = parsed;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    Thresholds thresholds;
+    std::vector<std::filesystem::path> baselinePaths;
+    std::vector<std::filesystem::path> currentPaths;
+    std::vector<std::filesystem::path> positional;
+    bool verbose = false;
+
+    const std::pair<const char*, double*> thresholdOptions[] = {
+        { "--time", &thresholds.time },
+        { "--time-floor", &thresholds.timeFloorMs },
+        { "--noise", &thresholds.noiseFactor },
+        { "--allocations", &thresholds.allocations },
+        { "--bytes", &thresholds.bytes },
+        { "--rss", &thresholds.rss }
+    };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        auto threshold = std::find_if(std::begin(thresholdOptions), std::end(thresholdOptions), [&](const std::pair<const char*, double*>& option)
+            {
+                return strcmp(argv[i], option.first) == 0;
+            });
+        if (strcmp(argv[i], "--help") == 0)
+        {
+            std::cout << "SimpleScript - Compare\n  Compares bench results against a baseline, exits with 1 if a metric regressed.\n\n  Usage\n"
+                "    ss-compare <baseline.json> <current.json> [options]\n"
+                "    ss-compare --baseline a.json --baseline b.json --current c.json [options]\n\n"
+                "  Runs from several files of the same side are pooled before taking the median.\n\n  Options\n"
+                "    --time F -- Allowed relative slowdown (default 0.10), widened by the noise of the runs\n"
+                "    --time-floor MS -- Time changes below this are ignored (default 0.5)\n"
+                "    --noise F -- Multiples of the median absolute deviation counted as noise (default 3)\n"
+                "    --allocations F -- Allowed relative growth in allocation count (default 0.02)\n"
+                "    --bytes F -- Allowed relative growth in allocated bytes (default 0.05)\n"
+                "    --rss F -- Allowed relative growth in peak memory (default 0.15)\n"
+                "    --verbose -- List every metric, not just the ones that changed\n\n";
+            return 0;
+        }
+        if (strcmp(argv[i], "--baseline") == 0 && hasValue)
+        {
+            baselinePaths.push_back(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--current") == 0 && hasValue)
+        {
+            currentPaths.push_back(argv[++i]);
+        }
+        else if (threshold != std::end(thresholdOptions) && hasValue)
+        {
+            if (!ParseThreshold(argv[++i], *threshold->second))
+            {
+                std::cout << argv[i] << " -- was not a recognized number for " << threshold->first << std::endl;
+                return 2;
+            }
+        }
+        else if (strcmp(argv[i], "--verbose") == 0)
+        {
+            verbose = true;
+        }
+        else if (argv[i][0] != '-')
+        {
+            positional.push_back(argv[i]);
+        }
+        else
+        {
+            std::cout << argv[i] << " -- was not a recognized option" << std::endl;
+            return 2;
+        }
+    }
+
+    if (positional.size() == 2 && baselinePaths.empty() && currentPaths.empty())
+    {
+        baselinePaths.push_back(positional[0]);
+        currentPaths.push_back(positional[1]);
+    }
+    else if (!positional.empty() || baselinePaths.empty() || currentPaths.empty())
+    {
+        std::cout << "Expected a baseline and a current result file, see --help" << std::endl;
+        return 2;
+    }
+
+    std::vector<BenchEntry> baseline;
+    std::vector<BenchEntry> current;
+    std::string error;
+    for (const std::filesystem::path& path : baselinePaths)
+    {
+        if (!Comparator::LoadResults(path, baseline, error))
+        {
+            std::cout << error << std::endl;
+            return 2;
+        }
+    }
+    for (const std::filesystem::path& path : currentPaths)
+    {
+        if (!Comparator::LoadResults(path, current, error))
+        {
+            std::cout << error << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<EntryResult> results = Comparator(thresholds).Compare(baseline, current);
+    std::cout << Comparator::Report(results, verbose);
+
+    return (Comparator::HasFailures(results)) ? 1 : 0;
+}
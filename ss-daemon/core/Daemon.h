@@ -0,0 +1,165 @@
+#pragma once
+
+#include "DaemonClient.h"
+#include "FileChecker.h"
+#include "LocalSocket.h"
+#include "Project.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+// Keeps a project parsed and hands it to the tools, DaemonClient is the other end.
+// Clients are answered one at a time, every answer is a copy of the project so there is nothing to share.
+class Daemon
+{
+public:
+	Daemon(const std::filesystem::path& projPath) : m_projPath(projPath), m_checker(projPath) {}
+
+	void SetPollInterval(int ms) { m_pollMs = ms; }
+	void SetWorkerCount(size_t count) { m_workerCount = count; }
+
+	// Serves until 'stop' is set or a client sends "stop". 1 -> could not listen.
+	int Run(const std::atomic<bool>& stop)
+	{
+		std::filesystem::path socketPath = DaemonClient::SocketPath(m_projPath);
+
+		std::string answer;
+		if (DaemonClient(m_projPath).Request("ping", answer))
+		{
+			std::cout << "ss-daemon is already running for " << m_projPath.string() << std::endl;
+			return 1;
+		}
+
+		if (!LocalSocket::CreatePrivateDirectory(socketPath.parent_path()))
+		{
+			std::cout << "Could not create a directory only this user can use at " << socketPath.parent_path().string() << std::endl;
+			return 1;
+		}
+
+		// Left behind by a daemon that did not shut down cleanly
+		std::error_code error;
+		std::filesystem::remove(socketPath, error);
+
+		if (!m_listener.Listen(socketPath))
+		{
+			std::cout << "Could not listen on " << socketPath.string() << std::endl;
+			return 1;
+		}
+
+		Refresh();
+		std::cout << "Serving " << m_projPath.string() << " on " << socketPath.string() << std::endl;
+
+		while (!stop && !m_stopRequested)
+		{
+			if (!m_listener.WaitReadable(m_pollMs))
+			{
+				Refresh();
+				continue;
+			}
+
+			LocalSocket client = m_listener.Accept();
+			if (client.IsOpen())
+				Serve(client);
+		}
+
+		m_listener.Close();
+		std::filesystem::remove(socketPath, error);
+		std::cout << "Stopped" << std::endl;
+		return 0;
+	}
+
+private:
+	// Reparses the whole project when anything in it changed since the last look
+	void Refresh()
+	{
+		if (!m_checker.CheckFiles() && m_project != nullptr)
+			return;
+
+		auto start = std::chrono::steady_clock::now();
+
+		std::unique_ptr<Project> project = std::make_unique<Project>();
+		project->SetWorkerCount(m_workerCount);
+		project->SetCollectDiagnostics(true);
+		project->Load(m_projPath);
+		m_project = std::move(project);
+
+		size_t errors = 0;
+		for (const Diagnostic& diagnostic : m_project->GetDiagnostics())
+		{
+			errors += (diagnostic.severity == Severity::Error) ? 1 : 0;
+		}
+
+		std::cout << "Loaded in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+			<< " ms, " << errors << " errors" << std::endl;
+	}
+
+	void Serve(LocalSocket& client)
+	{
+		client.SetTimeout(k_clientTimeoutMs);
+
+		std::string line;
+		if (!client.ReceiveLine(line, DaemonClient::k_maxLineLength))
+			return;
+
+		std::istringstream request(line);
+		std::string protocol;
+		std::string command;
+		request >> protocol >> command;
+		if (protocol != DaemonClient::k_protocol)
+		{
+			client.SendAll("error expected " + std::string(DaemonClient::k_protocol) + "\n");
+			return;
+		}
+
+		// An edit made since the last poll is picked up before answering
+		Refresh();
+
+		std::string payload;
+		if (command == "ping")
+		{
+			payload = m_projPath.string();
+		}
+		else if (command == "sequences")
+		{
+			size_t first = 0;
+			size_t count = 0;
+			if (!(request >> first >> count))
+			{
+				client.SendAll("error usage: sequences <first> <count>\n");
+				return;
+			}
+			payload = m_project->Serialize(m_projPath, first, count);
+		}
+		else if (command == "validate")
+		{
+			payload = m_project->Serialize(m_projPath, 0, 0);
+		}
+		else if (command == "stop")
+		{
+			m_stopRequested = true;
+		}
+		else
+		{
+			client.SendAll("error unknown command '" + command + "'\n");
+			return;
+		}
+
+		if (client.SendAll("ok " + std::to_string(payload.size()) + "\n"))
+			client.SendAll(payload);
+	}
+
+	// A client that connects and then says nothing must not stall everyone else
+	static constexpr int k_clientTimeoutMs = 2000;
+
+	std::filesystem::path m_projPath;
+	FileChecker m_checker;
+	LocalSocket m_listener;
+	std::unique_ptr<Project> m_project;
+	int m_pollMs = 250;
+	size_t m_workerCount = 0;
+	bool m_stopRequested = false;
+};
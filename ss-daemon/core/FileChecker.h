@@ -0,0 +1,43 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <system_error>
+
+// Polls the write times of everything in a project, like ss-view's FileChecker but keyed by the full path
+// so scenes with the same name in two sequences are told apart
+class FileChecker
+{
+public:
+	FileChecker(const std::filesystem::path& root) : m_root(root) {}
+
+	// false -> no change since the last call
+	bool CheckFiles()
+	{
+		std::map<std::filesystem::path, std::filesystem::file_time_type> current;
+
+		std::error_code error;
+		std::filesystem::recursive_directory_iterator it(m_root, error);
+		for (; !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+		{
+			std::filesystem::path filename = it->path().filename();
+			if (filename == ".git" || filename == ".backup")
+			{
+				it.disable_recursion_pending();
+				continue;
+			}
+
+			std::error_code timeError;
+			current[it->path()] = it->last_write_time(timeError);
+		}
+
+		// A file that vanished halfway through the walk is a change as well
+		bool result = error || current != m_files;
+		m_files = std::move(current);
+		return result;
+	}
+
+private:
+	std::filesystem::path m_root;
+	std::map<std::filesystem::path, std::filesystem::file_time_type> m_files;
+};
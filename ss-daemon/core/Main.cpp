@@ -0,0 +1,104 @@
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "Daemon.h"
+#include "DaemonClient.h"
+
+static std::atomic<bool> s_stop{ false };
+
+static void OnSignal(int)
+{
+    s_stop = true;
+}
+
+// std::stoul throws on text and strtoul alone accepts "-1" or "4x"
+static bool ParseCount(const char* str, size_t& value)
+{
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(str, &end, 10);
+    if (end == str || *end != '\0' || errno == ERANGE || str[0] == '-' || parsed > SIZE_MAX)
+        return false;
+
+    value = (size_t)parsed;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::filesystem::path projPath = std::filesystem::current_path();
+    int pollMs = 250;
+    size_t workers = 0;
+    bool doStop = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--help") == 0)
+        {
+            std::cout << "SimpleScript - Daemon\n  Keeps a project parsed in memory so ss-format and ss-export do not have to read it from disk.\n  The tools use it automatically while it runs.\n\n  Usage\n    ss-daemon [project directory] [options]\n\n  Options\n    --poll MS -- How often to look for changed files, in milliseconds (default 250)\n    --jobs N -- Number of worker threads used to parse (0 = all cores, the default)\n    --stop -- Stop the daemon running for the project\n\n";
+            return 0;
+        }
+        if (strcmp(argv[i], "--poll") == 0 && i + 1 < argc)
+        {
+            size_t value = 0;
+            if (!ParseCount(argv[++i], value) || value == 0 || value > INT_MAX)
+            {
+                std::cout << argv[i] << " -- was not a recognized number for --poll" << std::endl;
+                return 2;
+            }
+            pollMs = (int)value;
+        }
+        else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        {
+            if (!ParseCount(argv[++i], workers))
+            {
+                std::cout << argv[i] << " -- was not a recognized number for --jobs" << std::endl;
+                return 2;
+            }
+        }
+        else if (strcmp(argv[i], "--stop") == 0)
+        {
+            doStop = true;
+        }
+        else if (argv[i][0] != '-')
+        {
+            projPath = argv[i];
+        }
+        else
+        {
+            std::cout << argv[i] << " -- was not a recognized option" << std::endl;
+            return 2;
+        }
+    }
+
+    projPath = std::filesystem::absolute(projPath).lexically_normal();
+    if (!projPath.has_filename())
+        projPath = projPath.parent_path();
+
+    if (doStop)
+    {
+        std::string answer;
+        if (!DaemonClient(projPath).Request("stop", answer))
+        {
+            std::cout << "ss-daemon is not running for " << projPath.string() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    Daemon daemon(projPath);
+    daemon.SetPollInterval(pollMs);
+    daemon.SetWorkerCount(workers);
+    return daemon.Run(s_stop);
+}
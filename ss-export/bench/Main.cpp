@@ -0,0 +1,126 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "BenchHarness.h"
+#include "DocxExporter.h"
+#include "Project.h"
+#include "ProjectGenerator.h"
+#include "WordWrap.h"
+
+static void WrapAll(Project& proj, TextBlock::Type type, std::vector<std::string>(DocxExporter::* lineBreaks)(const std::string&))
+{
+	DocxExporter exporter;
+	size_t lines = 0;
+	proj.ForEach([&](TextBlock& block, TextBlock*)
+	{
+		if (block.type == type)
+			lines += (exporter.*lineBreaks)(block.content).size();
+		return false;
+	});
+
+	// Keeps the calls from being optimized away
+	if (lines == 0)
+		std::cerr << "bench -- no blocks to wrap" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchOptions options;
+	if (!options.Parse(argc, argv))
+	{
+		std::cerr << "usage: bench [--repeat=N] [--sizes=small,medium,huge] [--out=path]" << std::endl;
+		return 2;
+	}
+
+	BenchHarness harness("ss-export", options.repeat);
+	auto silent = [](const std::string&) {};
+
+	for (const std::string& size : options.sizes)
+	{
+		GeneratorOptions genOptions;
+		if (!genOptions.SetPreset(size))
+		{
+			std::cerr << "bench -- unknown size " << size << std::endl;
+			return 2;
+		}
+
+		// Loose formatting so every save has to rewrite the whole project
+		genOptions.messy = true;
+		std::filesystem::path root = std::filesystem::temp_directory_path() / ("ss-export-bench-" + size);
+		std::filesystem::path docxPath = std::filesystem::temp_directory_path() / ("ss-export-bench-" + size + ".docx");
+		auto generate = [&]()
+		{
+			std::filesystem::remove_all(root);
+			ProjectGenerator(genOptions).Generate(root);
+		};
+		generate();
+
+		std::unique_ptr<Project> loading;
+		harness.Run("Project::Load", size,
+			[&]() { loading = std::make_unique<Project>(); loading->MsgCallback(silent); },
+			[&]() { loading->Load(root); });
+		loading.reset();
+
+		Project proj;
+		proj.MsgCallback(silent);
+		proj.Load(root);
+
+		// The exporter has to wrap exactly like the word by word reference
+		DocxExporter wrapper;
+		bool wrapsMatch = true;
+		proj.ForEach([&](TextBlock& block, TextBlock*)
+		{
+			wrapsMatch = wrapsMatch
+				&& wrapper.DialogueLineBreaks(block.content) == WordWrap::LineBreaksReference(block.content, DIALOGUE_LIMIT)
+				&& wrapper.ParentheticalLineBreaks(block.content) == WordWrap::LineBreaksReference(block.content, PARENTH_LIMIT)
+				&& wrapper.ActionLineBreaks(block.content) == WordWrap::LineBreaksReference(block.content, ACTION_LIMIT);
+			return false;
+		});
+		if (!wrapsMatch)
+		{
+			std::cerr << "bench -- DocxExporter wraps differently from the reference (" << WordWrap::GetInstructionSet() << ")" << std::endl;
+			return 1;
+		}
+
+		harness.Run("DocxExporter::DialogueLineBreaks", size, nullptr,
+			[&]() { WrapAll(proj, TextBlock::Type::Dialogue, &DocxExporter::DialogueLineBreaks); });
+		harness.Run("DocxExporter::ParentheticalLineBreaks", size, nullptr,
+			[&]() { WrapAll(proj, TextBlock::Type::Parenthetical, &DocxExporter::ParentheticalLineBreaks); });
+		harness.Run("DocxExporter::ActionLineBreaks", size, nullptr,
+			[&]() { WrapAll(proj, TextBlock::Type::Action, &DocxExporter::ActionLineBreaks); });
+
+		harness.Run("DocxExporter::Export", size, nullptr, [&]()
+		{
+			DocxExporter exporter;
+			exporter.Export(docxPath, proj);
+		});
+
+		// The project is regenerated before every run, a second save of the same tree is a no-op
+		std::unique_ptr<Project> saving;
+		harness.Run("Project::Save", size,
+			[&]() { generate(); saving = std::make_unique<Project>(); saving->MsgCallback(silent); saving->Load(root); },
+			[&]() { saving->Save(root); });
+		saving.reset();
+
+		std::filesystem::remove_all(root);
+		std::filesystem::remove(docxPath);
+	}
+
+	if (options.out.empty())
+	{
+		harness.WriteJson(std::cout);
+		return 0;
+	}
+
+	std::ofstream file(options.out);
+	if (!file)
+	{
+		std::cerr << "bench -- could not write " << options.out << std::endl;
+		return 1;
+	}
+	harness.WriteJson(file);
+	return 0;
+}
@@ -0,0 +1,39 @@
+#include "AllocStats.h"
+
+#ifdef SS_ALLOC_STATS
+
+#include <cstdlib>
+#include <new>
+
+// Each block carries its size in front so a free can be subtracted from the live total.
+// 16 bytes keeps the returned pointer aligned for anything malloc would align for.
+static constexpr size_t k_header = 16;
+
+void* operator new(size_t size)
+{
+	void* block = std::malloc(size + k_header);
+	if (block == nullptr)
+		throw std::bad_alloc();
+
+	*(size_t*)block = size;
+	AllocStats::Get().OnAllocate(size);
+	return (char*)block + k_header;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void* ptr) noexcept
+{
+	if (ptr == nullptr)
+		return;
+
+	void* block = (char*)ptr - k_header;
+	AllocStats::Get().OnFree(*(size_t*)block);
+	std::free(block);
+}
+
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { operator delete(ptr); }
+
+#endif // SS_ALLOC_STATS
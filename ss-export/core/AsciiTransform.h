@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ASCII_TRANSFORM_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ASCII_TRANSFORM_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Case folding and slug to file name conversion, 16 or 32 bytes at a time.
+// Only 'a' to 'z' and 'A' to 'Z' are ever looked at, bytes of multibyte UTF-8 sequences are never letters.
+class AsciiTransform
+{
+public:
+	// Lower case ASCII letters to upper case in place, every other byte is left alone
+	static void ToUpper(char* data, size_t size)
+	{
+		size_t i = 0;
+#if defined(ASCII_TRANSFORM_AVX2)
+		for (; i + 32 <= size; i += 32)
+		{
+			__m256i bytes = _mm256_loadu_si256((const __m256i*)(data + i));
+			_mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(bytes, _mm256_and_si256(IsLower(bytes), _mm256_set1_epi8(0x20))));
+		}
+#elif defined(ASCII_TRANSFORM_SSE2)
+		for (; i + 16 <= size; i += 16)
+		{
+			__m128i bytes = _mm_loadu_si128((const __m128i*)(data + i));
+			_mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(bytes, _mm_and_si128(IsLower(bytes), _mm_set1_epi8(0x20))));
+		}
+#endif
+		ToUpperScalar(data + i, size - i);
+	}
+
+	static void ToUpperScalar(char* data, size_t size)
+	{
+		for (size_t i = 0; i < size; ++i)
+		{
+			if (data[i] >= 'a' && data[i] <= 'z')
+				data[i] -= 32;
+		}
+	}
+
+	// Letters in upper case, every run of anything else becomes one '_'. 'out' needs room for 'size' bytes.
+	// Returns the number of bytes written.
+	static size_t NameFromSlug(const char* in, size_t size, char* out)
+	{
+		size_t i = 0;
+		size_t written = 0;
+		bool lastWasSpecial = false;
+#if defined(ASCII_TRANSFORM_SSE2) || defined(ASCII_TRANSFORM_AVX2)
+		for (; i + 16 <= size; i += 16)
+		{
+			__m128i bytes = _mm_loadu_si128((const __m128i*)(in + i));
+			__m128i lower = IsLower(bytes);
+			__m128i letter = _mm_or_si128(lower, _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8('Z' + 1))));
+
+			// Letters folded to upper case, everything else replaced with '_'
+			__m128i folded = _mm_xor_si128(bytes, _mm_and_si128(lower, _mm_set1_epi8(0x20)));
+			__m128i mapped = _mm_or_si128(_mm_and_si128(letter, folded), _mm_andnot_si128(letter, _mm_set1_epi8('_')));
+
+			// A special byte is dropped when the byte before it was special too
+			uint32_t special = ~(uint32_t)_mm_movemask_epi8(letter) & 0xFFFF;
+			uint32_t keep = ~(special & ((special << 1) | (lastWasSpecial ? 1u : 0u))) & 0xFFFF;
+			lastWasSpecial = (special & 0x8000) != 0;
+
+			if (keep == 0xFFFF)
+			{
+				_mm_storeu_si128((__m128i*)(out + written), mapped);
+				written += 16;
+				continue;
+			}
+
+			alignas(16) char block[16];
+			_mm_store_si128((__m128i*)block, mapped);
+			for (; keep != 0; keep &= keep - 1)
+			{
+				out[written++] = block[LowestBit(keep)];
+			}
+		}
+#endif
+		return written + NameFromSlugScalar(in + i, size - i, out + written, lastWasSpecial);
+	}
+
+	// 'lastWasSpecial' carries a run of special bytes over from text before 'in'
+	static size_t NameFromSlugScalar(const char* in, size_t size, char* out, bool lastWasSpecial = false)
+	{
+		size_t written = 0;
+		for (size_t i = 0; i < size; ++i)
+		{
+			char c = in[i];
+			if (c >= 'A' && c <= 'Z')
+			{
+				lastWasSpecial = false;
+				out[written++] = c;
+				continue;
+			}
+			if (c >= 'a' && c <= 'z')
+			{
+				lastWasSpecial = false;
+				out[written++] = (char)(c - 32);
+				continue;
+			}
+
+			if (lastWasSpecial)
+				continue;
+
+			lastWasSpecial = true;
+			out[written++] = '_';
+		}
+		return written;
+	}
+
+private:
+#if defined(ASCII_TRANSFORM_AVX2)
+	// Bytes of 0x80 and above are negative as signed chars, so they never fall in the range
+	static __m256i IsLower(__m256i bytes)
+	{
+		return _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), bytes));
+	}
+#endif
+
+#if defined(ASCII_TRANSFORM_SSE2) || defined(ASCII_TRANSFORM_AVX2)
+	static __m128i IsLower(__m128i bytes)
+	{
+		return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8('z' + 1)));
+	}
+
+	static size_t LowestBit(uint32_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, bits);
+		return index;
+#else
+		return (size_t)__builtin_ctz(bits);
+#endif
+	}
+#endif
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+enum class Severity : uint8_t
+{
+	Note,
+	Warning,
+	Error // Stops a normal load
+};
+
+// A problem found while loading. Line and column start at 1, both are 0 when it is about the whole file.
+struct Diagnostic
+{
+	std::filesystem::path path;
+	size_t line = 0;
+	size_t column = 0;
+	Severity severity = Severity::Error;
+	std::string code;
+	std::string message;
+};
+
+// Line and column of byte offsets into a file, counts forward from the previous lookup
+class LineLocator
+{
+public:
+	LineLocator(std::string_view text) : m_text(text) {}
+
+	void Locate(size_t offset, size_t& line, size_t& column)
+	{
+		if (offset < m_offset)
+		{
+			m_offset = 0;
+			m_line = 1;
+			m_lineStart = 0;
+		}
+
+		for (; m_offset < offset && m_offset < m_text.size(); ++m_offset)
+		{
+			if (m_text[m_offset] == '\n')
+			{
+				++m_line;
+				m_lineStart = m_offset + 1;
+			}
+		}
+
+		line = m_line;
+		column = offset - m_lineStart + 1;
+	}
+
+private:
+	std::string_view m_text;
+	size_t m_offset = 0;
+	size_t m_line = 1;
+	size_t m_lineStart = 0;
+};
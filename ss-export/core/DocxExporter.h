@@ -1,6 +1,9 @@
 #pragma once
 
+#include "AllocStats.h"
+#include "Profiler.h"
 #include "Project.h"
+#include "WordWrap.h"
 
 #include <minidocx/minidocx.hpp>
 
@@ -14,14 +17,19 @@ class DocxExporter
 public:
 	void Export(const std::filesystem::path& filePath, Project& proj)
 	{
+		PROFILE_SCOPE("DocxExporter::Export");
+		ALLOC_PHASE(AllocPhase::Export);
 		m_document = new docx::Document();
 
 		m_lineCount = 0;
-		m_slugCount = 1;
+		m_slugCount = 1 + proj.GetSceneOffset();
 		m_lastCharacter = "";
 		m_wasLastBlockDialogue = false;
 
-		proj.ForEach([&](TextBlock& b, TextBlock* n) { return WriteBlock(b, n); });
+		{
+			PROFILE_SCOPE("DocxExporter::WriteBlocks");
+			proj.ForEach([&](TextBlock& b, TextBlock* n) { return WriteBlock(b, n); });
+		}
 
 		docx::Section sec = m_document->FirstSection();
 		sec.SetPageMargin(
@@ -30,7 +38,10 @@ public:
 			docx::Inch2Twip(1.),
 			docx::Inch2Twip(1.));
 
-		m_document->Save(filePath.string());
+		{
+			PROFILE_SCOPE("DocxExporter::Save");
+			m_document->Save(filePath.string());
+		}
 
 		delete m_document;
 	}
@@ -199,101 +210,27 @@ private:
 		return false;
 	}
 
+public:
+	// Public so the bench can time the wrapping on its own
 	std::vector<std::string> DialogueLineBreaks(const std::string& line)
 	{
-		std::stringstream stream(line);
-		std::vector<std::string> result;
-
-		int counter = 0;
-		std::string word;
-		std::string currLine;
-
-		while (std::getline(stream, word, ' '))
-		{
-			counter += word.length();
-			if (counter + 1 > DIALOGUE_LIMIT)
-			{
-				result.push_back(currLine);
-				counter = word.length();
-				currLine = word;
-				continue;
-			}
-			if (!currLine.empty())
-			{
-				currLine.push_back(' ');
-				++counter;
-			}
-			currLine.append(word);
-		}
-		result.push_back(currLine);
-
-		return result;
+		ALLOC_PHASE(AllocPhase::Wrap);
+		return WordWrap::LineBreaks(line, DIALOGUE_LIMIT);
 	}
 
 	std::vector<std::string> ParentheticalLineBreaks(const std::string& line)
 	{
-		std::stringstream stream(line);
-		std::vector<std::string> result;
-
-		int counter = 0;
-		std::string word;
-		std::string currLine;
-
-
-		while (std::getline(stream, word, ' '))
-		{
-			counter += word.length();
-			if (counter + 1 > PARENTH_LIMIT)
-			{
-				result.push_back(currLine);
-				counter = word.length();
-				currLine = word;
-
-				continue;
-			}
-			if (!currLine.empty())
-			{
-				currLine.push_back(' ');
-				++counter;
-			}
-			currLine.append(word);
-		}
-		result.push_back(currLine);
-
-		return result;
+		ALLOC_PHASE(AllocPhase::Wrap);
+		return WordWrap::LineBreaks(line, PARENTH_LIMIT);
 	}
 
 	std::vector<std::string> ActionLineBreaks(const std::string& line)
 	{
-		std::stringstream stream(line);
-		std::vector<std::string> result;
-
-		int counter = 0;
-		std::string word;
-		std::string currLine;
-
-		while (std::getline(stream, word, ' '))
-		{
-			counter += word.length();
-			if (counter + 1 > ACTION_LIMIT)
-			{
-				result.push_back(currLine);
-				counter = word.length();
-				currLine = word;
-				continue;
-			}
-			if (!currLine.empty())
-			{
-				currLine.push_back(' ');
-				++counter;
-			}
-			currLine.append(word);
-		}
-		result.push_back(currLine);
-
-		return result;
+		ALLOC_PHASE(AllocPhase::Wrap);
+		return WordWrap::LineBreaks(line, ACTION_LIMIT);
 	}
 
+private:
 	std::string SlugFormat(const uint32_t number, const std::string& line)
 	{
 		std::string numstr = std::to_string(number);
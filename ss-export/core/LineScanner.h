@@ -0,0 +1,269 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LINE_SCANNER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LINE_SCANNER_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// What a line starts with once leading whitespace is skipped
+enum class LineKind : uint8_t
+{
+	Slug, // #
+	Character, // [
+	Action, // *
+	Parenthetical, // (
+	Note, // //
+	Text
+};
+
+// A line with the whitespace trimmed from both ends, as offsets into the scanned text
+struct ScannedLine
+{
+	size_t begin = 0;
+	size_t end = 0;
+	LineKind kind = LineKind::Text;
+};
+
+// Splits text into lines, trims them and classifies them in one pass, 64 bytes at a time.
+// Whitespace is what Trim removes: '\n', '\t', '\r' and ' '. Blank lines are left out of the index.
+class LineScanner
+{
+public:
+	// Reads the whole file into memory and scans it, false if it could not be opened
+	bool Load(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+			return false;
+
+		std::streamoff size = file.tellg();
+		m_buffer.resize((size > 0) ? (size_t)size : 0);
+		file.seekg(0);
+		file.read(m_buffer.data(), (std::streamsize)m_buffer.size());
+		m_buffer.resize((size_t)file.gcount());
+
+		Scan(m_buffer);
+		return true;
+	}
+
+	// 'text' must outlive the lines
+	const std::vector<ScannedLine>& Scan(std::string_view text)
+	{
+		m_text = text;
+		m_lines.clear();
+
+		const char* data = text.data();
+		size_t size = text.size();
+		size_t first = std::string_view::npos;
+		size_t last = 0;
+
+		for (size_t base = 0; base < size; base += 64)
+		{
+			uint64_t newlines = 0;
+			uint64_t content = 0;
+			if (base + 64 <= size)
+			{
+				BlockMasks(data + base, newlines, content);
+			}
+			else
+			{
+				// Blanks past the end never start or extend a line
+				char tail[64];
+				std::memset(tail, ' ', sizeof(tail));
+				std::memcpy(tail, data + base, size - base);
+				BlockMasks(tail, newlines, content);
+			}
+
+			while (newlines != 0)
+			{
+				size_t newline = LowestBit(newlines);
+				uint64_t before = content & ((1ull << newline) - 1);
+				if (before != 0)
+				{
+					if (first == std::string_view::npos)
+						first = base + LowestBit(before);
+					last = base + HighestBit(before);
+				}
+
+				if (first != std::string_view::npos)
+					Emit(first, last + 1);
+
+				first = std::string_view::npos;
+				content &= ~((2ull << newline) - 1);
+				newlines &= newlines - 1;
+			}
+
+			if (content != 0)
+			{
+				if (first == std::string_view::npos)
+					first = base + LowestBit(content);
+				last = base + HighestBit(content);
+			}
+		}
+
+		if (first != std::string_view::npos)
+			Emit(first, last + 1);
+
+		return m_lines;
+	}
+
+	// Byte at a time, kept as the reference the vector path is checked against
+	const std::vector<ScannedLine>& ScanScalar(std::string_view text)
+	{
+		m_text = text;
+		m_lines.clear();
+
+		size_t start = 0;
+		while (start < text.size())
+		{
+			size_t end = text.find('\n', start);
+			if (end == std::string_view::npos)
+				end = text.size();
+
+			size_t first = start;
+			while (first < end && IsBlank(text[first]))
+				++first;
+
+			size_t last = end;
+			while (last > first && IsBlank(text[last - 1]))
+				--last;
+
+			if (first < last)
+				Emit(first, last);
+
+			start = end + 1;
+		}
+		return m_lines;
+	}
+
+	const std::vector<ScannedLine>& GetLines() const { return m_lines; }
+	std::string_view GetText() const { return m_text; }
+	std::string_view GetText(const ScannedLine& line) const { return m_text.substr(line.begin, line.end - line.begin); }
+
+	static std::string_view Trim(std::string_view str)
+	{
+		size_t first = 0;
+		while (first < str.size() && IsBlank(str[first]))
+			++first;
+
+		size_t last = str.size();
+		while (last > first && IsBlank(str[last - 1]))
+			--last;
+
+		return str.substr(first, last - first);
+	}
+
+	static const char* GetInstructionSet()
+	{
+#if defined(LINE_SCANNER_AVX2)
+		return "AVX2";
+#elif defined(LINE_SCANNER_SSE2)
+		return "SSE2";
+#else
+		return "scalar";
+#endif
+	}
+
+private:
+	static bool IsBlank(char c) { return c == '\n' || c == '\t' || c == '\r' || c == ' '; }
+
+	void Emit(size_t begin, size_t end)
+	{
+		ScannedLine& line = m_lines.emplace_back();
+		line.begin = begin;
+		line.end = end;
+
+		switch (m_text[begin])
+		{
+		case '#': line.kind = LineKind::Slug; break;
+		case '[': line.kind = LineKind::Character; break;
+		case '*': line.kind = LineKind::Action; break;
+		case '(': line.kind = LineKind::Parenthetical; break;
+		case '/': line.kind = (end - begin >= 2 && m_text[begin + 1] == '/') ? LineKind::Note : LineKind::Text; break;
+		default: line.kind = LineKind::Text; break;
+		}
+	}
+
+	// Bit i of 'newlines' is set for a '\n' at block[i], bit i of 'content' for anything that is not whitespace
+	static void BlockMasks(const char* block, uint64_t& newlines, uint64_t& content)
+	{
+#if defined(LINE_SCANNER_AVX2)
+		const __m256i newline = _mm256_set1_epi8('\n');
+		const __m256i tab = _mm256_set1_epi8('\t');
+		const __m256i carriage = _mm256_set1_epi8('\r');
+		const __m256i space = _mm256_set1_epi8(' ');
+		for (size_t i = 0; i < 64; i += 32)
+		{
+			__m256i bytes = _mm256_loadu_si256((const __m256i*)(block + i));
+			__m256i isNewline = _mm256_cmpeq_epi8(bytes, newline);
+			__m256i isBlank = _mm256_or_si256(_mm256_or_si256(isNewline, _mm256_cmpeq_epi8(bytes, tab)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(bytes, carriage), _mm256_cmpeq_epi8(bytes, space)));
+
+			newlines |= (uint64_t)(uint32_t)_mm256_movemask_epi8(isNewline) << i;
+			content |= (uint64_t)(uint32_t)~_mm256_movemask_epi8(isBlank) << i;
+		}
+#elif defined(LINE_SCANNER_SSE2)
+		const __m128i newline = _mm_set1_epi8('\n');
+		const __m128i tab = _mm_set1_epi8('\t');
+		const __m128i carriage = _mm_set1_epi8('\r');
+		const __m128i space = _mm_set1_epi8(' ');
+		for (size_t i = 0; i < 64; i += 16)
+		{
+			__m128i bytes = _mm_loadu_si128((const __m128i*)(block + i));
+			__m128i isNewline = _mm_cmpeq_epi8(bytes, newline);
+			__m128i isBlank = _mm_or_si128(_mm_or_si128(isNewline, _mm_cmpeq_epi8(bytes, tab)),
+				_mm_or_si128(_mm_cmpeq_epi8(bytes, carriage), _mm_cmpeq_epi8(bytes, space)));
+
+			newlines |= (uint64_t)_mm_movemask_epi8(isNewline) << i;
+			content |= (uint64_t)(~_mm_movemask_epi8(isBlank) & 0xFFFF) << i;
+		}
+#else
+		for (size_t i = 0; i < 64; ++i)
+		{
+			newlines |= (uint64_t)(block[i] == '\n') << i;
+			content |= (uint64_t)!IsBlank(block[i]) << i;
+		}
+#endif
+	}
+
+	static size_t LowestBit(uint64_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, bits);
+		return index;
+#else
+		return (size_t)__builtin_ctzll(bits);
+#endif
+	}
+
+	static size_t HighestBit(uint64_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse64(&index, bits);
+		return index;
+#else
+		return 63 - (size_t)__builtin_clzll(bits);
+#endif
+	}
+
+	std::string m_buffer;
+	std::string_view m_text;
+	std::vector<ScannedLine> m_lines;
+};
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // NOMINMAX
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif // _WIN32
+
+// Unix domain stream socket, Windows 10 has them as well through afunix.h.
+// Both ends only talk to processes of the same user, sockets live in a directory no one else can enter.
+class LocalSocket
+{
+#ifdef _WIN32
+	using Handle = SOCKET;
+	static constexpr Handle k_invalid = INVALID_SOCKET;
+#else
+	using Handle = int;
+	static constexpr Handle k_invalid = -1;
+#endif // _WIN32
+
+public:
+	LocalSocket() = default;
+	~LocalSocket() { Close(); }
+
+	LocalSocket(const LocalSocket& other) = delete;
+	LocalSocket operator=(const LocalSocket& other) = delete;
+
+	LocalSocket(LocalSocket&& other) noexcept : m_handle(other.m_handle), m_buffer(std::move(other.m_buffer)) { other.m_handle = k_invalid; }
+	LocalSocket& operator=(LocalSocket&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			m_handle = other.m_handle;
+			m_buffer = std::move(other.m_buffer);
+			other.m_handle = k_invalid;
+		}
+		return *this;
+	}
+
+	bool IsOpen() const { return m_handle != k_invalid; }
+
+	// A directory for sockets that only the current user can use, 'name' keeps tools apart
+	static std::filesystem::path PrivateDirectory(const std::string& name)
+	{
+		std::error_code error;
+#ifdef _WIN32
+		// The temp directory is already private to the user
+		return std::filesystem::temp_directory_path(error) / name;
+#else
+		const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+		if (runtime != nullptr && runtime[0] == '/')
+			return std::filesystem::path(runtime) / name;
+
+		// Shared with every user, the user id keeps the name free
+		return std::filesystem::temp_directory_path(error) / (name + "-" + std::to_string(geteuid()));
+#endif // _WIN32
+	}
+
+	// true -> 'path' is a directory owned by the current user that no one else can read or write
+	static bool IsPrivateDirectory(const std::filesystem::path& path)
+	{
+#ifdef _WIN32
+		std::error_code error;
+		return std::filesystem::is_directory(path, error);
+#else
+		struct stat info;
+		return lstat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode) && info.st_uid == geteuid() && (info.st_mode & 0077) == 0;
+#endif // _WIN32
+	}
+
+	// Creates 'path' when it is missing, false if it is missing or exists but is not private
+	static bool CreatePrivateDirectory(const std::filesystem::path& path)
+	{
+#ifdef _WIN32
+		std::error_code error;
+		std::filesystem::create_directories(path, error);
+#else
+		mkdir(path.c_str(), 0700);
+#endif // _WIN32
+		return IsPrivateDirectory(path);
+	}
+
+	// false -> nothing is listening at 'path', or it belongs to another user
+	bool Connect(const std::filesystem::path& path)
+	{
+		sockaddr_un address{};
+		if (!IsOwnSocket(path) || !MakeAddress(path, address) || !Open())
+			return false;
+
+		if (connect(m_handle, (const sockaddr*)&address, sizeof(address)) != 0 || !IsPeerSameUser())
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	// 'path' must not exist yet
+	bool Listen(const std::filesystem::path& path)
+	{
+		sockaddr_un address{};
+		if (!MakeAddress(path, address) || !Open())
+			return false;
+
+#ifndef _WIN32
+		// The socket file is created owner-only rather than with the default permissions
+		mode_t previousMask = umask(0077);
+#endif // _WIN32
+		bool isListening = bind(m_handle, (const sockaddr*)&address, sizeof(address)) == 0 && listen(m_handle, 8) == 0;
+#ifndef _WIN32
+		umask(previousMask);
+#endif // _WIN32
+
+		if (!isListening)
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	// The result is closed when the client runs as another user
+	LocalSocket Accept()
+	{
+		LocalSocket client;
+		client.m_handle = accept(m_handle, nullptr, nullptr);
+		if (client.IsOpen() && !client.IsPeerSameUser())
+			client.Close();
+		return client;
+	}
+
+	// true -> there is something to read or a connection to accept
+	bool WaitReadable(int timeoutMs)
+	{
+		if (!m_buffer.empty())
+			return true;
+
+		fd_set readable;
+		FD_ZERO(&readable);
+		FD_SET(m_handle, &readable);
+		timeval timeout{ timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+		return select((int)m_handle + 1, &readable, nullptr, nullptr, &timeout) > 0;
+	}
+
+	// Receives give up after 'timeoutMs' so a stuck peer can not hang the other side
+	void SetTimeout(int timeoutMs)
+	{
+#ifdef _WIN32
+		DWORD timeout = (DWORD)timeoutMs;
+#else
+		timeval timeout{ timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+#endif // _WIN32
+		setsockopt(m_handle, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+		setsockopt(m_handle, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+	}
+
+	bool SendAll(std::string_view data)
+	{
+		while (!data.empty())
+		{
+			int chunk = (int)std::min<size_t>(data.size(), 1 << 20);
+			int sent = (int)send(m_handle, data.data(), chunk, k_sendFlags);
+			if (sent <= 0)
+				return false;
+
+			data.remove_prefix((size_t)sent);
+		}
+		return true;
+	}
+
+	// Reads up to a '\n' and drops it, false if the connection closed or the line is longer than 'maxLength'
+	bool ReceiveLine(std::string& line, size_t maxLength)
+	{
+		size_t end;
+		while ((end = m_buffer.find('\n')) == std::string::npos)
+		{
+			if (m_buffer.size() > maxLength || !Fill())
+				return false;
+		}
+
+		line = m_buffer.substr(0, end);
+		m_buffer.erase(0, end + 1);
+		return true;
+	}
+
+	bool ReceiveExact(size_t size, std::string& data)
+	{
+		data = std::move(m_buffer);
+		m_buffer.clear();
+		if (data.size() > size)
+		{
+			m_buffer = data.substr(size);
+			data.resize(size);
+			return true;
+		}
+
+		size_t received = data.size();
+		data.resize(size);
+		while (received < size)
+		{
+			int chunk = (int)std::min<size_t>(size - received, 1 << 20);
+			int count = (int)recv(m_handle, &data[received], chunk, 0);
+			if (count <= 0)
+				return false;
+
+			received += (size_t)count;
+		}
+		return true;
+	}
+
+	void Close()
+	{
+		if (m_handle == k_invalid)
+			return;
+
+#ifdef _WIN32
+		closesocket(m_handle);
+#else
+		close(m_handle);
+#endif // _WIN32
+		m_handle = k_invalid;
+		m_buffer.clear();
+	}
+
+private:
+#ifdef MSG_NOSIGNAL
+	// A peer that went away must not kill the process with SIGPIPE
+	static constexpr int k_sendFlags = MSG_NOSIGNAL;
+#else
+	static constexpr int k_sendFlags = 0;
+#endif
+
+	bool Open()
+	{
+#ifdef _WIN32
+		static const bool started = []() { WSADATA data; return WSAStartup(MAKEWORD(2, 2), &data) == 0; }();
+		if (!started)
+			return false;
+#endif // _WIN32
+
+		Close();
+		m_handle = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (m_handle == k_invalid)
+			return false;
+
+#ifdef SO_NOSIGPIPE
+		int on = 1;
+		setsockopt(m_handle, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+		return true;
+	}
+
+	// Windows has no peer credentials for AF_UNIX, the private directory is what keeps other users out there
+	bool IsPeerSameUser() const
+	{
+#if defined(_WIN32)
+		return true;
+#elif defined(__linux__)
+		ucred credentials{};
+		socklen_t size = sizeof(credentials);
+		return getsockopt(m_handle, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == 0 && credentials.uid == geteuid();
+#else
+		uid_t uid = 0;
+		gid_t gid = 0;
+		return getpeereid(m_handle, &uid, &gid) == 0 && uid == geteuid();
+#endif
+	}
+
+	static bool IsOwnSocket(const std::filesystem::path& path)
+	{
+#ifdef _WIN32
+		return true;
+#else
+		struct stat info;
+		return lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode) && info.st_uid == geteuid();
+#endif // _WIN32
+	}
+
+	bool Fill()
+	{
+		char chunk[4096];
+		int count = (int)recv(m_handle, chunk, sizeof(chunk), 0);
+		if (count <= 0)
+			return false;
+
+		m_buffer.append(chunk, (size_t)count);
+		return true;
+	}
+
+	static bool MakeAddress(const std::filesystem::path& path, sockaddr_un& address)
+	{
+		std::string name = path.string();
+		if (name.size() >= sizeof(address.sun_path))
+			return false;
+
+		address.sun_family = AF_UNIX;
+		std::memcpy(address.sun_path, name.c_str(), name.size() + 1);
+		return true;
+	}
+
+	Handle m_handle = k_invalid;
+	std::string m_buffer; // Received past the last line
+};
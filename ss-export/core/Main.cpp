@@ -1,9 +1,29 @@
 #include <iostream>
 
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 
 #include "Project.h"
+#include "AllocStats.h"
+#include "DaemonClient.h"
 #include "DocxExporter.h"
+#include "Profiler.h"
+
+// std::stoul throws on text and strtoul alone accepts "-1" or "4x"
+static bool ParseCount(const char* str, size_t& value)
+{
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(str, &end, 10);
+    if (end == str || *end != '\0' || errno == ERANGE || str[0] == '-' || parsed > SIZE_MAX)
+        return false;
+
+    value = (size_t)parsed;
+    return true;
+}
 
 int main (int argc, char* argv[])
 {
@@ -16,21 +36,89 @@ int main (int argc, char* argv[])
 
 
     std::string path = std::filesystem::current_path().filename().string() + ".docx";
+    std::string tracePath;
+    bool printAllocStats = false;
+    bool useDaemon = true;
+    size_t firstSequence = 0;
+    size_t sequenceCount = SIZE_MAX;
+    std::string sequenceRange;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strncmp(argv[i], "--trace=", 8) == 0)
+        {
+            tracePath = argv[i] + 8;
+            Profiler::Get().SetEnabled(true);
+        }
+        else if (strcmp(argv[i], "--alloc-stats") == 0)
+        {
+            printAllocStats = true;
+            if (!AllocStats::IsCompiledIn())
+            {
+                std::cout << "--alloc-stats -- this build does not count allocations, regenerate with 'premake5 --alloc-stats'" << std::endl;
+            }
+        }
+        else if (strcmp(argv[i], "--no-daemon") == 0)
+        {
+            useDaemon = false;
+        }
+        else if (strncmp(argv[i], "--sequences=", 12) == 0)
+        {
+            // N or N-M, counting from 1
+            std::string range = argv[i] + 12;
+            size_t dash = range.find('-');
+            std::string firstText = range.substr(0, dash);
+            std::string lastText = (dash == std::string::npos) ? firstText : range.substr(dash + 1);
+            size_t lastSequence = 0;
+            if (!ParseCount(firstText.c_str(), firstSequence) || !ParseCount(lastText.c_str(), lastSequence)
+                || firstSequence == 0 || lastSequence < firstSequence)
+            {
+                std::cout << argv[i] << " -- expected --sequences=N or --sequences=N-M, counting from 1" << std::endl;
+                return 2;
+            }
+            sequenceCount = lastSequence - firstSequence + 1;
+            firstSequence -= 1;
+            sequenceRange = argv[i];
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
 
-    Project p;
 #ifdef _DEBUG
-    p.Load(std::filesystem::current_path() / "prj");
+    std::filesystem::path projPath = std::filesystem::current_path() / "prj";
 #else
-    p.Load(std::filesystem::current_path());
+    std::filesystem::path projPath = std::filesystem::current_path();
 #endif
 
-    if (argc > 1)
+    // A running ss-daemon already has the project parsed
+    Project p;
+    if (!useDaemon || !DaemonClient(projPath).Fetch(p, firstSequence, sequenceCount))
+    {
+        p.Load(projPath);
+        p.KeepSequences(firstSequence, sequenceCount);
+    }
+
+    // Both paths clamp a range past the end down to nothing
+    if (!sequenceRange.empty() && p.GetNumberOfSequences() == 0)
     {
-        path = argv[1];
+        std::cout << sequenceRange << " -- the project has fewer than " << firstSequence + 1 << " sequences" << std::endl;
+        return 2;
     }
 
     DocxExporter exp;
     exp.Export(path, p);
 
+    if (!tracePath.empty() && !Profiler::Get().WriteTrace(tracePath))
+    {
+        std::cout << "Could not write trace to " << tracePath << std::endl;
+    }
+
+    if (printAllocStats && AllocStats::IsCompiledIn())
+    {
+        AllocStats::Get().Print(std::cout);
+    }
+
     return 0;
 }
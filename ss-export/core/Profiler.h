@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Scoped timers feed a fixed size ring buffer. When disabled a timer costs one relaxed atomic load.
+class Profiler final
+{
+public:
+	struct Event
+	{
+		const char* name = nullptr;
+		uint32_t thread = 0;
+		int64_t start = 0; // microseconds since the profiler was created
+		int64_t duration = 0;
+	};
+
+	struct Summary
+	{
+		const char* name = nullptr;
+		size_t count = 0;
+		double averageMs = 0.0;
+		double maxMs = 0.0;
+	};
+
+private:
+	Profiler() : m_origin(std::chrono::steady_clock::now()), m_events(k_capacity) {}
+
+public:
+	static Profiler& Get() { static Profiler instance; return instance; }
+
+	Profiler(const Profiler& other) = delete;
+	Profiler operator=(const Profiler& other) = delete;
+
+	void SetEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+	bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+	int64_t Now() const
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_origin).count();
+	}
+
+	void Record(const char* name, int64_t start, int64_t end)
+	{
+		Event event;
+		event.name = name;
+		event.thread = (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+		event.start = start;
+		event.duration = end - start;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_events[m_next] = event;
+		m_next = (m_next + 1) % k_capacity;
+		m_count = std::min(m_count + 1, k_capacity);
+	}
+
+	// Oldest first
+	std::vector<Event> GetEvents()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::vector<Event> result;
+		result.reserve(m_count);
+		size_t first = (m_next + k_capacity - m_count) % k_capacity;
+		for (size_t i = 0; i < m_count; ++i)
+		{
+			result.push_back(m_events[(first + i) % k_capacity]);
+		}
+		return result;
+	}
+
+	// One entry per timer name, in order of first appearance
+	std::vector<Summary> Summarize()
+	{
+		std::vector<Summary> result;
+		for (const Event& event : GetEvents())
+		{
+			auto summary = std::find_if(result.begin(), result.end(), [&](const Summary& s) { return strcmp(s.name, event.name) == 0; });
+			if (summary == result.end())
+			{
+				summary = result.emplace(result.end());
+				summary->name = event.name;
+			}
+
+			double ms = event.duration / 1000.0;
+			summary->averageMs += ms;
+			summary->maxMs = std::max(summary->maxMs, ms);
+			++summary->count;
+		}
+
+		for (Summary& summary : result)
+		{
+			summary.averageMs /= summary.count;
+		}
+		return result;
+	}
+
+	// Chrome trace_event format, open with chrome://tracing or ui.perfetto.dev
+	bool WriteTrace(const std::filesystem::path& path)
+	{
+		std::ofstream file(path);
+		if (!file)
+			return false;
+
+		file << "{\"traceEvents\":[";
+		bool isFirst = true;
+		for (const Event& event : GetEvents())
+		{
+			if (!isFirst)
+				file << ",";
+			isFirst = false;
+
+			file << "\n{\"name\":\"" << event.name << "\",\"cat\":\"ss\",\"ph\":\"X\",\"ts\":" << event.start
+				<< ",\"dur\":" << event.duration << ",\"pid\":0,\"tid\":" << event.thread << "}";
+		}
+		file << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+		return true;
+	}
+
+private:
+	static constexpr size_t k_capacity = 16384;
+
+	std::atomic<bool> m_enabled{ false };
+	std::chrono::steady_clock::time_point m_origin;
+
+	std::vector<Event> m_events;
+	size_t m_next = 0;
+	size_t m_count = 0;
+	std::mutex m_mutex;
+};
+
+class ScopedTimer
+{
+public:
+	// name must outlive the profiler, pass a string literal
+	ScopedTimer(const char* name)
+	{
+		if (!Profiler::Get().IsEnabled())
+			return;
+
+		m_name = name;
+		m_start = Profiler::Get().Now();
+	}
+
+	~ScopedTimer()
+	{
+		if (m_name != nullptr)
+			Profiler::Get().Record(m_name, m_start, Profiler::Get().Now());
+	}
+
+	ScopedTimer(const ScopedTimer& other) = delete;
+	ScopedTimer operator=(const ScopedTimer& other) = delete;
+
+private:
+	const char* m_name = nullptr;
+	int64_t m_start = 0;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__)(name)
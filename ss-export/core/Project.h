@@ -1,25 +1,108 @@
 #pragma once
 
+#include "AllocStats.h"
+#include "AsciiTransform.h"
 #include "TextBlock.h"
 #include "Character.h"
-
+#include "Diagnostic.h"
+#include "LineScanner.h"
+#include "ParallelFor.h"
+#include "Profiler.h"
+#include "Wire.h"
+
+#include <algorithm>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
-#include <unordered_set>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif // _WIN32
+
 struct Sequence
 {
 	std::string name;
 	std::vector<TextBlock> blocks;
 };
 
+struct SavePlan
+{
+	struct Write
+	{
+		std::filesystem::path path;
+		std::string contents;
+	};
+
+	struct Rename
+	{
+		std::filesystem::path from;
+		std::filesystem::path to;
+	};
+
+	// All paths are relative to the project directory
+	std::vector<Write> writes;
+	std::vector<Rename> renames;
+	std::vector<std::filesystem::path> removes;
+	std::vector<std::filesystem::path> touched; // Existing files that will be overwritten or removed
+	std::vector<std::filesystem::path> directories;
+	std::vector<std::filesystem::path> oldDirectories;
+	size_t unchanged = 0;
+
+	bool IsEmpty() const { return writes.empty() && renames.empty() && removes.empty(); }
+};
+
+enum class BackupStrategy
+{
+	Move,	// Rename every touched file into '.backup'
+	Link,	// Hard link overwritten files, rename removed files
+	Copy	// Copy every touched file
+};
+
+enum class FsyncPolicy
+{
+	None,	// Leave flushing to the OS
+	PerFile	// Flush each file to disk before it replaces the original
+};
+
+struct BackupStats
+{
+	size_t filesMoved = 0;
+	size_t filesLinked = 0;
+	size_t filesCopied = 0;
+	uintmax_t bytesMoved = 0;
+	uintmax_t bytesLinked = 0;
+	uintmax_t bytesCopied = 0;
+};
+
 class Project
 {
+	struct SceneLoad
+	{
+		size_t sequence = 0;
+		std::filesystem::path path;
+		std::vector<TextBlock> blocks;
+		std::string fatalError; // Set by a worker, reported once every worker has finished
+	};
+
+	struct SceneSave
+	{
+		size_t sequence = 0;
+		size_t slugIndex = 0;
+		size_t fileNumber = 0;
+	};
+
 public:
 	void ForEach(std::function<bool(TextBlock&, TextBlock*)> callback)
 	{
@@ -35,8 +118,20 @@ public:
 	}
 
 	void MsgCallback(const std::function<void(const std::string&)> msgCallback) { m_print = msgCallback; }
+	// Threads used to parse, render and write scenes. 1 is serial, 0 uses every hardware thread.
+	void SetWorkerCount(const size_t count) { m_workerCount = count; }
+	void SetBackupStrategy(const BackupStrategy strategy) { m_backupStrategy = strategy; }
+	void SetFsyncPolicy(const FsyncPolicy policy) { m_fsyncPolicy = policy; }
+	const BackupStats& GetBackupStats() const { return m_backupStats; }
+	// Scenes in the sequences left out by KeepSequences or a partial fetch from ss-daemon, the rest are numbered after them
+	size_t GetSceneOffset() const { return m_sceneOffset; }
+
+	size_t GetNumberOfSequences() const { return m_sequences.size(); }
+
 	void Load(const std::filesystem::path& projDirectory)
 	{
+		PROFILE_SCOPE("Project::Load");
+		ALLOC_PHASE(AllocPhase::Load);
 		if (!std::filesystem::exists(projDirectory))
 		{
 			Print("Project Directory does not exist");
@@ -52,45 +147,283 @@ public:
 			Print("Note -- '_char.txt' was not found.");
 		}
 
+		std::vector<std::filesystem::path> sequencePaths;
 		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(projDirectory))
 		{
-			if (entry.is_regular_file())
+			if (entry.is_regular_file() || IsIgnoredDirectory(entry.path()))
 				continue;
 
-#ifdef _DEBUG
-			if (entry.path().filename() == "int")
+			sequencePaths.push_back(entry.path());
+		}
+		std::sort(sequencePaths.begin(), sequencePaths.end());
+
+		std::vector<SceneLoad> scenes;
+		for (const std::filesystem::path& sequencePath : sequencePaths)
+		{
+			LoadSequence(sequencePath, scenes);
+		}
+
+		// Scenes are parsed independently and stitched together in order afterwards
+		ParallelFor(scenes.size(), m_workerCount, [&](size_t i) { LoadScene(scenes[i]); });
+		ReportFatalError(scenes, 0, scenes.size());
+
+		for (SceneLoad& scene : scenes)
+		{
+			Sequence& seq = m_sequences[scene.sequence];
+			seq.blocks.insert(seq.blocks.end(), std::make_move_iterator(scene.blocks.begin()), std::make_move_iterator(scene.blocks.end()));
+		}
+	}
+
+	void Save(const std::filesystem::path& projPath)
+	{
+		SavePlan plan = PlanSave(projPath);
+		ApplySave(projPath, plan);
+
+		Print("Saved -- " + std::to_string(plan.writes.size()) + " written, "
+			+ std::to_string(plan.renames.size()) + " renamed, "
+			+ std::to_string(plan.removes.size()) + " removed, "
+			+ std::to_string(plan.unchanged) + " unchanged");
+	}
+
+	// Renders the project in memory and diffs it against what is on disk. Nothing is written.
+	SavePlan PlanSave(const std::filesystem::path& projPath)
+	{
+		SavePlan plan;
+
+		std::vector<SavePlan::Write> rendered = Render(plan.directories);
+		std::vector<std::filesystem::path> existingPaths = ListFiles(projPath, plan.oldDirectories);
+
+		std::vector<std::string> existingContents(existingPaths.size());
+		ParallelFor(existingPaths.size(), m_workerCount, [&](size_t i) { existingContents[i] = ReadFile(projPath / existingPaths[i]); });
+
+		std::map<std::filesystem::path, std::string> existing;
+		for (size_t i = 0; i < existingPaths.size(); ++i)
+		{
+			existing[existingPaths[i]] = std::move(existingContents[i]);
+		}
+
+		std::set<std::filesystem::path> targets;
+		for (const SavePlan::Write& write : rendered)
+		{
+			targets.insert(write.path);
+		}
+
+		// Files that already match are kept, everything else is a candidate rename source
+		std::set<std::filesystem::path> kept;
+		std::vector<bool> isDone(rendered.size(), false);
+		for (size_t i = 0; i < rendered.size(); ++i)
+		{
+			auto found = existing.find(rendered[i].path);
+			if (found != existing.end() && found->second == rendered[i].contents)
+			{
+				kept.insert(rendered[i].path);
+				isDone[i] = true;
+				++plan.unchanged;
+			}
+		}
+
+		std::unordered_map<std::string, std::vector<std::filesystem::path>> byContents;
+		for (auto& pair : existing)
+		{
+			if (kept.find(pair.first) == kept.end())
+				byContents[pair.second].push_back(pair.first);
+		}
+
+		std::set<std::filesystem::path> moved;
+		for (size_t i = 0; i < rendered.size(); ++i)
+		{
+			if (isDone[i])
 				continue;
-#endif // _DEBUG
 
-			if (entry.path().filename() == ".git")
+			auto found = byContents.find(rendered[i].contents);
+			if (found != byContents.end() && !found->second.empty())
+			{
+				plan.renames.push_back({ found->second.back(), rendered[i].path });
+				moved.insert(found->second.back());
+				found->second.pop_back();
 				continue;
+			}
 
-			if (entry.path().filename() == ".backup")
+			plan.writes.push_back(std::move(rendered[i]));
+		}
+
+		for (auto& pair : existing)
+		{
+			if (kept.find(pair.first) != kept.end() || moved.find(pair.first) != moved.end())
 				continue;
 
-			LoadSequence(entry.path());
+			// Overwritten by a write or rename, or no longer part of the project
+			plan.touched.push_back(pair.first);
+			if (targets.find(pair.first) == targets.end())
+				plan.removes.push_back(pair.first);
 		}
+
+		return plan;
 	}
 
-	void Save(const std::filesystem::path& projPath)
+	// Renders every file Save would produce, with paths relative to the project directory
+	std::vector<SavePlan::Write> Render(std::vector<std::filesystem::path>& directories)
 	{
-		NewBackup(projPath);
-
-		SaveCharacters(projPath / "_char.txt");
+		directories.clear();
 
+		// File numbers only depend on the number of slugs before a scene, so every scene can be rendered on its own
+		std::vector<SceneSave> scenes;
 		size_t fileCounter = 0;
+		for (size_t i = 0; i < m_sequences.size(); ++i)
+		{
+			const Sequence& seq = m_sequences[i];
+			if (!seq.blocks.empty() && seq.blocks.front().type != TextBlock::Slug)
+			{
+				Print("Fatal Error -- Sequence doesn't begin with a slug line");
+				exit(1);
+			}
+
+			for (size_t j = 0; j < seq.blocks.size(); ++j)
+			{
+				if (seq.blocks[j].type == TextBlock::Slug)
+					scenes.push_back({ i, j, fileCounter++ });
+			}
+		}
 
 		for (size_t i = 0; i < m_sequences.size(); ++i)
 		{
-			std::string name = TwoDig(i) + "_" + m_sequences[i].name;
-			std::filesystem::create_directories(projPath / name);
-			SaveSequence(projPath / name, m_sequences[i], fileCounter);
+			directories.push_back(PadNumber(i, 2) + "_" + m_sequences[i].name);
+		}
+
+		std::vector<SavePlan::Write> rendered(scenes.size() + 1);
+		rendered[0] = { "_char.txt", RenderCharacters() };
+		ParallelFor(scenes.size(), m_workerCount, [&](size_t i)
+			{
+				const SceneSave& scene = scenes[i];
+				const Sequence& seq = m_sequences[scene.sequence];
+				SavePlan::Write& write = rendered[i + 1];
+				write.path = directories[scene.sequence] / (PadNumber(scene.fileNumber, 3) + "_" + NameFromSlug(seq.blocks[scene.slugIndex].content) + ".txt");
+				RenderScene(seq, scene.slugIndex, write.contents);
+			});
+
+		return rendered;
+	}
+
+	// Script files currently in the project, with paths relative to the project directory
+	std::vector<std::filesystem::path> ListFiles(const std::filesystem::path& projPath, std::vector<std::filesystem::path>& directories)
+	{
+		directories.clear();
+
+		std::vector<std::filesystem::path> files;
+		if (std::filesystem::exists(projPath / "_char.txt"))
+		{
+			files.push_back("_char.txt");
+		}
+
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(projPath))
+		{
+			if (entry.is_regular_file() || IsIgnoredDirectory(entry.path()))
+				continue;
+
+			directories.push_back(entry.path().filename());
+			for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(entry.path()))
+			{
+				if (!file.is_regular_file() || file.path().extension() != ".txt")
+					continue;
+
+				files.push_back(entry.path().filename() / file.path().filename());
+			}
+		}
+
+		return files;
+	}
+
+	// Drops every sequence outside [first, first + count)
+	void KeepSequences(size_t first, size_t count)
+	{
+		first = std::min(first, m_sequences.size());
+		count = std::min(count, m_sequences.size() - first);
+
+		for (size_t i = 0; i < first; ++i)
+		{
+			m_sceneOffset += std::count_if(m_sequences[i].blocks.begin(), m_sequences[i].blocks.end(), [](const TextBlock& block) { return block.type == TextBlock::Slug; });
 		}
+
+		m_sequences.erase(m_sequences.begin() + first + count, m_sequences.end());
+		m_sequences.erase(m_sequences.begin(), m_sequences.begin() + first);
+	}
+
+	// Takes the place of Load with what ss-daemon sent, see ss-format's Project::Serialize. false -> the data is damaged,
+	// or it has errors a normal load stops on, load from disk instead so they are reported the usual way.
+	bool Deserialize(const std::filesystem::path& projPath, std::string_view data)
+	{
+		PROFILE_SCOPE("Project::Deserialize");
+		ALLOC_PHASE(AllocPhase::Load);
+		WireReader in(data);
+		size_t sceneOffset = (size_t)in.U64();
+
+		std::vector<Diagnostic> diagnostics(in.Count(41));
+		for (Diagnostic& diagnostic : diagnostics)
+		{
+			uint8_t severity = in.U8();
+			if (severity > (uint8_t)Severity::Error)
+				return false;
+
+			diagnostic.severity = (Severity)severity;
+			diagnostic.line = in.U64();
+			diagnostic.column = in.U64();
+			diagnostic.path = projPath / std::filesystem::path(in.String());
+			diagnostic.code = in.String();
+			diagnostic.message = in.String();
+		}
+
+		CharacterCollection characters;
+		characters.data.resize(in.Count(20));
+		for (Character& c : characters.data)
+		{
+			c.name = in.String();
+			c.notes = in.String();
+			c.color.r = in.U8();
+			c.color.g = in.U8();
+			c.color.b = in.U8();
+			c.color.a = in.U8();
+		}
+
+		std::vector<Sequence> sequences(in.Count(16));
+		for (Sequence& seq : sequences)
+		{
+			seq.name = in.String();
+			seq.blocks.resize(in.Count(17));
+			for (TextBlock& block : seq.blocks)
+			{
+				// Render and Save switch on the type, anything they have no case for is damaged data
+				uint8_t type = in.U8();
+				if (type > TextBlock::Note)
+					return false;
+
+				block.type = (TextBlock::Type)type;
+				block.character = in.String();
+				block.content = in.String();
+			}
+		}
+
+		if (!in.IsValid() || !in.IsAtEnd())
+			return false;
+
+		if (std::any_of(diagnostics.begin(), diagnostics.end(), [](const Diagnostic& diagnostic) { return diagnostic.severity == Severity::Error; }))
+			return false;
+
+		// Printed the way Load prints them
+		for (const Diagnostic& diagnostic : diagnostics)
+		{
+			Print((diagnostic.severity == Severity::Note) ? "Note -- " + diagnostic.message : diagnostic.message);
+		}
+
+		m_sequences = std::move(sequences);
+		m_characters = std::move(characters);
+		m_sceneOffset = sceneOffset;
+		return true;
 	}
 
 private:
 	void Print(const std::string& msg)
 	{
+		std::lock_guard<std::mutex> lock(m_printMutex);
 		if (m_print == nullptr)
 		{
 			std::cout << msg << std::endl;
@@ -102,19 +435,17 @@ private:
 
 	void LoadCharacters(const std::filesystem::path& charPath)
 	{
-		std::ifstream file(charPath);
+		LineScanner scanner;
+		scanner.Load(charPath);
 
 		std::string charName = "";
 		Color charColor{};
 
-		std::string line;
-		while(std::getline(file, line))
+		for (const ScannedLine& scanned : scanner.GetLines())
 		{
-			Trim(line);
-			if (line.empty())
-				continue;
+			std::string_view line = scanner.GetText(scanned);
 
-			if (line[0] == '[')
+			if (scanned.kind == LineKind::Character)
 			{
 				size_t nameEnd = line.find_first_of(']');
 				size_t colBegin = line.find_first_of('{');
@@ -124,7 +455,7 @@ private:
 
 				if (nameEnd == std::string::npos)
 				{
-					Print("No Character end point fount for line: " + line);
+					Print("No Character end point fount for line: " + std::string(line));
 					if (colBegin == std::string::npos)
 					{
 						charName = line.substr(1);
@@ -157,7 +488,7 @@ private:
 					std::stringstream colorStream;
 					if (colEnd == std::string::npos)
 					{
-						Print("No Color end point fount for line: " + line);
+						Print("No Color end point fount for line: " + std::string(line));
 						colorStream << line.substr(colBegin + 1);
 					}
 					else
@@ -227,13 +558,13 @@ private:
 			// No special character
 			if (charName.empty())
 			{
-				Print("Fatal Error -- No current character name for line: " + line);
+				Print("Fatal Error -- No current character name for line: " + std::string(line));
 				exit(1);
 			}
 
 			if (!m_characters[charName].notes.empty())
 			{
-				m_characters[charName].notes += "\n" + line;
+				m_characters[charName].notes.append("\n").append(line);
 			}
 			else
 			{
@@ -242,7 +573,7 @@ private:
 		}
 	}
 
-	void LoadSequence(const std::filesystem::path& sequencePath)
+	void LoadSequence(const std::filesystem::path& sequencePath, std::vector<SceneLoad>& scenes)
 	{
 		std::string name = sequencePath.filename().string();
 		std::size_t underscoreIndex = name.find_first_of('_');
@@ -254,20 +585,43 @@ private:
 		Sequence& seq = m_sequences.emplace_back();
 		seq.name = name;
 
+		std::vector<std::filesystem::path> scenePaths;
 		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(sequencePath))
 		{
 			if (!entry.is_regular_file() || entry.path().extension() != ".txt")
 				continue;
 
-			LoadScene(entry.path(), seq);
+			scenePaths.push_back(entry.path());
+		}
+		std::sort(scenePaths.begin(), scenePaths.end());
+
+		for (const std::filesystem::path& scenePath : scenePaths)
+		{
+			SceneLoad& scene = scenes.emplace_back();
+			scene.sequence = m_sequences.size() - 1;
+			scene.path = scenePath;
 		}
 	}
 
-	void LoadScene(const std::filesystem::path& scenePath, Sequence& seq)
+	// exit() on a worker would run static destructors while the other workers still parse, so the first error in scene order is reported after the join
+	void ReportFatalError(const std::vector<SceneLoad>& scenes, size_t begin, size_t end)
 	{
-		std::ifstream file(scenePath);
+		for (size_t i = begin; i < end; ++i)
+		{
+			if (scenes[i].fatalError.empty())
+				continue;
+
+			Print("Fatal Error -- " + scenes[i].fatalError);
+			exit(1);
+		}
+	}
 
-		if (!file.is_open())
+	void LoadScene(SceneLoad& scene)
+	{
+		const std::filesystem::path& scenePath = scene.path;
+		std::vector<TextBlock>& blocks = scene.blocks;
+		LineScanner scanner;
+		if (!scanner.Load(scenePath))
 		{
 			Print("Could not open file: " + scenePath.string());
 			return;
@@ -275,204 +629,336 @@ private:
 
 		std::string lastCharacter = "";
 
-		std::string line{};
-		while (std::getline(file, line))
+		for (const ScannedLine& scanned : scanner.GetLines())
 		{
-			Trim(line);
-			if (line.empty())
-				continue;
+			std::string_view line = scanner.GetText(scanned);
 
-			if (line[0] == '#')
+			if (scanned.kind == LineKind::Slug)
 			{
-				ToCaps(line);
-				TextBlock& block = seq.blocks.emplace_back();
+				TextBlock& block = blocks.emplace_back();
 				block.type = TextBlock::Slug;
-				block.content = line.substr(1);
-				Trim(block.content);
+				block.content = LineScanner::Trim(line.substr(1));
+				ToCaps(block.content);
 				continue;
 			}
-			if (line[0] == '[')
+			if (scanned.kind == LineKind::Character)
 			{
 				size_t closeIndex = line.find_first_of(']');
 				if (closeIndex == std::string::npos)
 				{
-					Print("Expecting close bracket for character specifier on line: " + line);
+					Print("Expecting close bracket for character specifier on line: " + std::string(line));
 					lastCharacter = line.substr(1);
 					ToCaps(lastCharacter);
 					continue;
 				}
-				lastCharacter = line.substr(1, closeIndex - 1);
+				lastCharacter = LineScanner::Trim(line.substr(1, closeIndex - 1));
 				ToCaps(lastCharacter);
-				Trim(lastCharacter);
 				continue;
 			}
-			if (line[0] == '*')
+			if (scanned.kind == LineKind::Action)
 			{
-				TextBlock& block = seq.blocks.emplace_back();
+				TextBlock& block = blocks.emplace_back();
 				block.type = TextBlock::Action;
-				block.content = line.substr(1);
-				Trim(block.content);
+				block.content = LineScanner::Trim(line.substr(1));
 				continue;
 			}
-			if (line[0] == '(')
+			if (scanned.kind == LineKind::Parenthetical)
 			{
 				if (lastCharacter.empty())
 				{
-					Print("Fatal Error -- No Character assigned for parenthetical: " + line);
-					exit(1);
+					scene.fatalError = "No Character assigned for parenthetical: " + std::string(line);
+					return;
 				}
 
-				TextBlock& block = seq.blocks.emplace_back();
+				TextBlock& block = blocks.emplace_back();
 				block.type = TextBlock::Parenthetical;
 				block.character = lastCharacter;
 
 				size_t endIndex = line.find_last_of(')');
 				if (endIndex == std::string::npos)
 				{
-					Print("Expecting close parethesis for character specifier on line: " + line);
-					block.content = line.substr(1);
-					Trim(block.content);
+					Print("Expecting close parethesis for character specifier on line: " + std::string(line));
+					block.content = LineScanner::Trim(line.substr(1));
 					continue;
 				}
 
-				block.content = line.substr(1, endIndex - 1);
-				Trim(block.content);
+				block.content = LineScanner::Trim(line.substr(1, endIndex - 1));
 
 				continue;
 			}
-			if (line.length() >= 2 && line.substr(0, 2) == "//")
+			if (scanned.kind == LineKind::Note)
 			{
-				std::string note = line.substr(2);
-				Trim(note);
+				std::string_view note = LineScanner::Trim(line.substr(2));
 				if (!note.empty())
 				{
-				    TextBlock& block = seq.blocks.emplace_back();
+				    TextBlock& block = blocks.emplace_back();
 				    block.type = TextBlock::Note;
 					block.content = note;
-					Trim(block.content);
 				}
 				continue;
 			}
 
 			if (lastCharacter.empty())
 			{
-				Print("Fatal Error -- No Character assigned for dialogue: " + line);
-				exit(1);
+				scene.fatalError = "No Character assigned for dialogue: " + std::string(line);
+				return;
 			}
 
-			TextBlock& block = seq.blocks.emplace_back();
+			TextBlock& block = blocks.emplace_back();
 			block.type = TextBlock::Dialogue;
 			block.character = lastCharacter;
 			block.content = line;
 		}
 	}
 
-	void NewBackup(const std::filesystem::path projPath)
+	bool IsIgnoredDirectory(const std::filesystem::path& path)
 	{
-		if (std::filesystem::exists(projPath / ".backup"))
+#ifdef _DEBUG
+		if (path.filename() == "int")
+			return true;
+#endif // _DEBUG
+
+		if (path.filename() == ".git")
+			return true;
+
+		if (path.filename() == ".backup")
+			return true;
+
+		return false;
+	}
+
+	std::string ReadFile(const std::filesystem::path& path)
+	{
+		std::ifstream file(path);
+		std::stringstream contents;
+		contents << file.rdbuf();
+		return contents.str();
+	}
+
+	// false -> the file could not be created, nothing was written
+	bool WriteFile(const std::filesystem::path& path, const std::string& contents)
+	{
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp";
+
+#ifdef _WIN32
+		// Keep the CRLF line endings text mode streams used to write
+		std::string buffer;
+		buffer.reserve(contents.size() + std::count(contents.begin(), contents.end(), '\n'));
+		for (const char c : contents)
 		{
-			std::filesystem::remove_all(projPath / ".backup");
+			if (c == '\n')
+				buffer.push_back('\r');
+			buffer.push_back(c);
 		}
-		std::filesystem::create_directories(projPath / ".backup");
+		FILE* file = _wfopen(tempPath.c_str(), L"wb");
+#else
+		const std::string& buffer = contents;
+		FILE* file = fopen(tempPath.c_str(), "wb");
+#endif // _WIN32
 
-		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(projPath))
+		if (file == nullptr)
+			return false;
+
+		// Unbuffered so the whole file goes out in a single write
+		setvbuf(file, nullptr, _IONBF, 0);
+		fwrite(buffer.data(), 1, buffer.size(), file);
+
+		if (m_fsyncPolicy == FsyncPolicy::PerFile)
 		{
-			if (entry.path().filename() == ".git")
-				continue;
+#ifdef _WIN32
+			_commit(_fileno(file));
+#else
+			fsync(fileno(file));
+#endif // _WIN32
+		}
+		fclose(file);
 
-			if (entry.path().filename() == ".gitattributes")
-				continue;
+		std::filesystem::rename(tempPath, path);
+		return true;
+	}
 
-			if (entry.path().filename() == ".gitignore")
-				continue;
+	void ApplySave(const std::filesystem::path& projPath, const SavePlan& plan)
+	{
+		if (!plan.touched.empty())
+		{
+			NewBackup(projPath, plan);
+		}
 
-			if (entry.path().filename() == ".backup")
-				continue;
+		for (const std::filesystem::path& dir : plan.directories)
+		{
+			std::filesystem::create_directories(projPath / dir);
+		}
 
-			if (entry.path().has_extension() && entry.path().extension() != ".txt")
-				continue;
+		// Renames are staged so that files can swap or shift names without clobbering each other
+		std::vector<std::filesystem::path> staged;
+		for (const SavePlan::Rename& rename : plan.renames)
+		{
+			std::filesystem::path stagedPath = projPath / rename.to;
+			stagedPath += ".rename";
+			std::filesystem::rename(projPath / rename.from, stagedPath);
+			staged.push_back(stagedPath);
+		}
 
-#ifdef _DEBUG
-			if (entry.path().filename() == "int")
+		for (const std::filesystem::path& path : plan.removes)
+		{
+			std::filesystem::remove(projPath / path);
+		}
+
+		std::vector<char> isWritten(plan.writes.size(), 0);
+		ParallelFor(plan.writes.size(), m_workerCount, [&](size_t i) { isWritten[i] = WriteFile(projPath / plan.writes[i].path, plan.writes[i].contents); });
+
+		// Reported here rather than on the worker, exit() there would race the writes still running
+		for (size_t i = 0; i < plan.writes.size(); ++i)
+		{
+			if (isWritten[i])
 				continue;
-#endif // _DEBUG
 
-			std::filesystem::copy(entry.path(), projPath / ".backup" / entry.path().filename(), std::filesystem::copy_options::recursive);
+			std::filesystem::path tempPath = projPath / plan.writes[i].path;
+			tempPath += ".tmp";
+			Print("Fatal Error -- Could not write file: " + tempPath.string());
+			exit(1);
+		}
 
-			std::filesystem::remove_all(entry.path());
+		for (size_t i = 0; i < plan.renames.size(); ++i)
+		{
+			std::filesystem::rename(staged[i], projPath / plan.renames[i].to);
+		}
+
+		for (const std::filesystem::path& dir : plan.oldDirectories)
+		{
+			if (std::find(plan.directories.begin(), plan.directories.end(), dir) != plan.directories.end())
+				continue;
+
+			if (std::filesystem::is_empty(projPath / dir))
+			{
+				std::filesystem::remove(projPath / dir);
+			}
+			else
+			{
+				Print("Note -- '" + dir.string() + "' still contains non-script files and was not removed");
+			}
 		}
 	}
 
-	void SaveCharacters(const std::filesystem::path& charPath)
+	void NewBackup(const std::filesystem::path& projPath, const SavePlan& plan)
 	{
-		std::ofstream file(charPath);
+		m_backupStats = BackupStats();
 
-		for (const Character& c : m_characters.data)
+		if (std::filesystem::exists(projPath / ".backup"))
 		{
-			file << '[' << c.name << "]{ "
-				<< std::to_string((int)c.color.r) << ", "
-				<< std::to_string((int)c.color.g) << ", "
-				<< std::to_string((int)c.color.b) << ", "
-				<< std::to_string((int)c.color.a) << " }" << std::endl;
+			std::filesystem::remove_all(projPath / ".backup");
+		}
+		std::filesystem::create_directories(projPath / ".backup");
 
-			if (c.notes.empty())
+		for (const std::filesystem::path& path : plan.touched)
+		{
+			std::filesystem::path source = projPath / path;
+			std::filesystem::path dest = projPath / ".backup" / path;
+			std::filesystem::create_directories(dest.parent_path());
+
+			std::error_code ec;
+			uintmax_t size = std::filesystem::file_size(source, ec);
+			if (ec)
+				size = 0;
+
+			// Removed files are never read again, overwritten files are replaced by rename so a link keeps the old contents
+			bool isRemoved = std::find(plan.removes.begin(), plan.removes.end(), path) != plan.removes.end();
+			if (m_backupStrategy == BackupStrategy::Move || (m_backupStrategy == BackupStrategy::Link && isRemoved))
 			{
-				file << std::endl;
-				continue;
+				std::filesystem::rename(source, dest, ec);
+				if (!ec)
+				{
+					++m_backupStats.filesMoved;
+					m_backupStats.bytesMoved += size;
+					continue;
+				}
+			}
+			else if (m_backupStrategy == BackupStrategy::Link)
+			{
+				std::filesystem::create_hard_link(source, dest, ec);
+				if (!ec)
+				{
+					++m_backupStats.filesLinked;
+					m_backupStats.bytesLinked += size;
+					continue;
+				}
 			}
 
-			file << c.notes << std::endl << std::endl;
+			// Fallback for filesystems without hard links or backups on another volume
+			std::filesystem::copy_file(source, dest, std::filesystem::copy_options::overwrite_existing);
+			++m_backupStats.filesCopied;
+			m_backupStats.bytesCopied += size;
 		}
+
+		Print("Backup -- " + std::to_string(m_backupStats.filesMoved) + " moved (" + std::to_string(m_backupStats.bytesMoved) + " bytes), "
+			+ std::to_string(m_backupStats.filesLinked) + " linked (" + std::to_string(m_backupStats.bytesLinked) + " bytes), "
+			+ std::to_string(m_backupStats.filesCopied) + " copied (" + std::to_string(m_backupStats.bytesCopied) + " bytes)");
 	}
 
-	void SaveSequence(const std::filesystem::path& sequencePath, const Sequence& seq, size_t& fileCounter)
+	std::string RenderCharacters()
 	{
-		std::ofstream file;
-		std::string lastCharName = "";
-		for (const TextBlock& block : seq.blocks)
+		size_t size = 0;
+		for (const Character& c : m_characters.data)
 		{
-			if (block.type == TextBlock::Slug)
-			{
-				if (file.is_open())
-					file.close();
+			size += c.name.length() + c.notes.length() + 32;
+		}
 
-				std::string filename = ThreeDig(fileCounter++) + "_" + NameFromSlug(block.content) + ".txt";
+		std::string result;
+		result.reserve(size);
 
-				file.open(sequencePath / filename);
+		for (const Character& c : m_characters.data)
+		{
+			result.append(1, '[').append(c.name).append("]{ ")
+				.append(std::to_string((int)c.color.r)).append(", ")
+				.append(std::to_string((int)c.color.g)).append(", ")
+				.append(std::to_string((int)c.color.b)).append(", ")
+				.append(std::to_string((int)c.color.a)).append(" }\n");
 
-				file << "# " << block.content << std::endl << std::endl;
+			if (c.notes.empty())
+			{
+				result.append(1, '\n');
 				continue;
 			}
 
-			if (!file.is_open())
-			{
-				Print("Fatal Error -- Sequence doesn't begin with a slug line");
-				exit(1);
-			}
+			result.append(c.notes).append("\n\n");
+		}
+
+		return result;
+	}
+
+	void RenderScene(const Sequence& seq, size_t slugIndex, std::string& file)
+	{
+		file.reserve(SceneSize(seq, slugIndex));
+		file.append("# ").append(seq.blocks[slugIndex].content).append("\n\n");
 
+		std::string lastCharName = "";
+		for (size_t i = slugIndex + 1; i < seq.blocks.size() && seq.blocks[i].type != TextBlock::Slug; ++i)
+		{
+			const TextBlock& block = seq.blocks[i];
 			switch (block.type)
 			{
 			case TextBlock::Action:
-				file << "* " << block.content << std::endl << std::endl;
+				file.append("* ").append(block.content).append("\n\n");
 				break;
 			case TextBlock::Note:
-				file << "// " << block.content << std::endl << std::endl;
+				file.append("// ").append(block.content).append("\n\n");
 				break;
 			case TextBlock::Parenthetical:
 				if (block.character != lastCharName)
 				{
-					file << '[' << block.character << ']' << std::endl;
+					file.append(1, '[').append(block.character).append("]\n");
 					lastCharName = block.character;
 				}
-				file << '(' << block.content << ')' << std::endl << std::endl;
+				file.append(1, '(').append(block.content).append(")\n\n");
 				break;
 			case TextBlock::Dialogue:
 				if (block.character != lastCharName)
 				{
-					file << '[' << block.character << ']' << std::endl;
+					file.append(1, '[').append(block.character).append("]\n");
 					lastCharName = block.character;
 				}
-				file << block.content << std::endl << std::endl;
+				file.append(block.content).append("\n\n");
 				break;
 			default:
 				Print(std::string("Save Sequence -- `TextBlock` enum not implemented"));
@@ -481,74 +967,44 @@ private:
 		}
 	}
 
-	void Trim(std::string& str)
+	// Upper bound of the rendered size of the scene starting at 'slugIndex'
+	size_t SceneSize(const Sequence& seq, size_t slugIndex)
 	{
-		std::unordered_set<char> whitespace = { '\n', '\t', '\r', ' ' };
-		while (!str.empty() && whitespace.find(str.front()) != whitespace.end())
-		{
-			str.erase(0, 1);
-		}
-		while (!str.empty() && whitespace.find(str.back()) != whitespace.end())
+		size_t size = seq.blocks[slugIndex].content.length() + 4;
+		for (size_t i = slugIndex + 1; i < seq.blocks.size() && seq.blocks[i].type != TextBlock::Slug; ++i)
 		{
-			str.pop_back();
+			size += seq.blocks[i].content.length() + seq.blocks[i].character.length() + 8;
 		}
+		return size;
 	}
 
-	void ToCaps(std::string& str)
+	void Trim(std::string& str)
 	{
-		for (char& c : str)
-		{
-			if (c >= 'a' && c <= 'z')
-			{
-				c -= 32;
-			}
-		}
+		std::string_view trimmed = LineScanner::Trim(str);
+		str.erase(trimmed.data() - str.data() + trimmed.size());
+		str.erase(0, trimmed.data() - str.data());
 	}
 
-	std::string TwoDig(size_t val)
+	void ToCaps(std::string& str)
 	{
-		if (val < 10)
-			return "0" + std::to_string(val);
-
-		return std::to_string(val);
+		AsciiTransform::ToUpper(str.data(), str.size());
 	}
 
-	std::string ThreeDig(size_t val)
+	std::string PadNumber(size_t val, size_t digits)
 	{
-		if (val < 10)
-			return "00" + std::to_string(val);
-		if (val < 100)
-			return "0" + std::to_string(val);
+		std::string result = std::to_string(val);
+		if (result.length() < digits)
+			result.insert(0, digits - result.length(), '0');
 
-		return std::to_string(val);
+		return result;
 	}
 
-	std::string NameFromSlug(const std::string& line)
+	std::string NameFromSlug(std::string_view line)
 	{
-		std::stringstream result;
-		bool lastWasSpecial = false;
-		for (const char& c : line)
-		{
-			if (c >= 'A' && c <= 'Z')
-			{
-				lastWasSpecial = false;
-				result << c;
-				continue;
-			}
-			if (c >= 'a' && c <= 'z')
-			{
-				lastWasSpecial = false;
-				result << (char)(c - 32);
-				continue;
-			}
-
-			if (lastWasSpecial)
-				continue;
-
-			lastWasSpecial = true;
-			result << '_';
-		}
-		return result.str();
+		// Never longer than the slug, runs of special characters only shrink it
+		std::string result(line.size(), '\0');
+		result.resize(AsciiTransform::NameFromSlug(line.data(), line.size(), result.data()));
+		return result;
 	}
 
 private:
@@ -571,4 +1027,10 @@ private:
 	std::vector<Sequence> m_sequences;
 	CharacterCollection m_characters;
 	std::function<void(const std::string&)> m_print = nullptr;
+	std::mutex m_printMutex;
+	size_t m_workerCount = 1;
+	BackupStrategy m_backupStrategy = BackupStrategy::Link;
+	FsyncPolicy m_fsyncPolicy = FsyncPolicy::None;
+	BackupStats m_backupStats;
+	size_t m_sceneOffset = 0;
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// Length prefixed fields for sending a parsed project between ss-daemon and the tools.
+// Both ends run on the same machine, so numbers go out in native byte order.
+class WireWriter
+{
+public:
+	WireWriter(std::string& out) : m_out(out) {}
+
+	void U8(uint8_t value) { m_out.push_back((char)value); }
+	void U64(uint64_t value) { m_out.append((const char*)&value, sizeof(value)); }
+	void String(std::string_view value)
+	{
+		U64(value.size());
+		m_out.append(value);
+	}
+
+private:
+	std::string& m_out;
+};
+
+// Every read past the end returns zero or empty and leaves IsValid() false from then on
+class WireReader
+{
+public:
+	WireReader(std::string_view data) : m_data(data) {}
+
+	bool IsValid() const { return m_valid; }
+	bool IsAtEnd() const { return m_offset == m_data.size(); }
+
+	uint8_t U8()
+	{
+		if (!Has(1))
+			return 0;
+
+		return (uint8_t)m_data[m_offset++];
+	}
+
+	uint64_t U64()
+	{
+		uint64_t value = 0;
+		if (!Has(sizeof(value)))
+			return 0;
+
+		std::memcpy(&value, m_data.data() + m_offset, sizeof(value));
+		m_offset += sizeof(value);
+		return value;
+	}
+
+	std::string_view String()
+	{
+		uint64_t size = U64();
+		if (!Has(size))
+			return {};
+
+		std::string_view value = m_data.substr(m_offset, (size_t)size);
+		m_offset += (size_t)size;
+		return value;
+	}
+
+	// Counts of items that are at least 'minSize' bytes each, so a corrupt count cannot reserve gigabytes
+	uint64_t Count(size_t minSize)
+	{
+		uint64_t count = U64();
+		if (count > (m_data.size() - m_offset) / minSize)
+		{
+			m_valid = false;
+			return 0;
+		}
+		return count;
+	}
+
+private:
+	bool Has(uint64_t size)
+	{
+		if (m_valid && size <= m_data.size() - m_offset)
+			return true;
+
+		m_valid = false;
+		return false;
+	}
+
+	std::string_view m_data;
+	size_t m_offset = 0;
+	bool m_valid = true;
+};
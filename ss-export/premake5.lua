@@ -1,3 +1,9 @@
+newoption
+{
+    trigger = "alloc-stats",
+    description = "Count allocations per phase, printed with --alloc-stats"
+}
+
 workspace "ss-export"
 architecture "x64"
     configurations { "Debug", "Release" }
@@ -34,6 +40,9 @@ project "core"
 		systemversion "latest"
 		defines { "WIN32" }
 
+    filter "options:alloc-stats"
+        defines { "SS_ALLOC_STATS" }
+
 	filter "configurations:Debug"
 		defines { "_DEBUG", "_CONSOLE" }
 		symbols "On"
@@ -50,3 +59,49 @@ project "core"
             "minidocx"
         }
 
+
+project "bench"
+    location "%{prj.name}"
+    kind "ConsoleApp"
+    language "C++"
+    targetname "%{prj.name}"
+    targetdir ("bin/".. outputdir)
+    objdir ("%{prj.name}/int/" .. outputdir)
+    cppdialect "C++17"
+    staticruntime "Off"
+
+    files
+    {
+        "%{prj.name}/**.h",
+        "%{prj.name}/**.cpp"
+    }
+
+    includedirs
+    {
+        "core",
+        "core/include",
+        "../ss-gen/core"
+    }
+
+    libdirs "core/lib"
+
+    filter "system:windows"
+		systemversion "latest"
+		defines { "WIN32" }
+
+    filter "system:linux"
+        links { "minidocx", "pthread" }
+
+	filter { "system:windows", "configurations:Debug" }
+        links { "minidocx-d" }
+
+	filter { "system:windows", "configurations:Release" }
+        links { "minidocx" }
+
+	filter "configurations:Debug"
+		defines { "_DEBUG", "_CONSOLE" }
+		symbols "On"
+
+    filter "configurations:Release"
+		defines { "NDEBUG", "_CONSOLE" }
+		optimize "On"
@@ -0,0 +1,77 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Project.h"
+#include "ProjectGenerator.h"
+
+static void Generate(const std::filesystem::path& root, size_t sequences, size_t scenes)
+{
+	std::filesystem::remove_all(root);
+
+	// Loose formatting so the first save has to rewrite every file
+	GeneratorOptions options;
+	options.sequences = sequences;
+	options.scenes = scenes;
+	options.messy = true;
+	ProjectGenerator(options).Generate(root);
+}
+
+template <typename Func>
+static double Time(Func func)
+{
+	auto start = std::chrono::steady_clock::now();
+	func();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+	size_t sceneCount = 2000;
+	if (argc > 1)
+	{
+		sceneCount = std::stoul(argv[1]);
+	}
+
+	const size_t sequences = 20;
+	std::filesystem::path root = std::filesystem::temp_directory_path() / "ss-format-bench";
+
+	struct Config
+	{
+		FsyncPolicy policy;
+		size_t workers;
+	};
+
+	for (const Config& config : { Config{ FsyncPolicy::None, 1 }, Config{ FsyncPolicy::PerFile, 1 }, Config{ FsyncPolicy::None, 0 }, Config{ FsyncPolicy::PerFile, 0 } })
+	{
+		FsyncPolicy policy = config.policy;
+		Generate(root, sequences, sceneCount);
+
+		Project proj;
+		proj.MsgCallback([](const std::string&) {});
+		proj.SetFsyncPolicy(policy);
+		proj.SetWorkerCount(config.workers);
+
+		Project reloaded;
+		reloaded.MsgCallback([](const std::string&) {});
+		reloaded.SetFsyncPolicy(policy);
+		reloaded.SetWorkerCount(config.workers);
+
+		double load = Time([&]() { proj.Load(root); });
+		double cold = Time([&]() { proj.Save(root); });
+		double reload = Time([&]() { reloaded.Load(root); });
+		double warm = Time([&]() { reloaded.Save(root); });
+
+		std::cout << ((policy == FsyncPolicy::None) ? "fsync none" : "fsync per-file")
+			<< ((config.workers == 1) ? ", serial" : ", parallel") << " (" << sceneCount << " scenes)\n"
+			<< "  load:           " << load << " ms\n"
+			<< "  save (rewrite): " << cold << " ms\n"
+			<< "  reload:         " << reload << " ms\n"
+			<< "  save (no-op):   " << warm << " ms\n";
+	}
+
+	std::filesystem::remove_all(root);
+	return 0;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "LocalSocket.h"
+#include "Project.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+// ss-daemon keeps a project parsed in memory and answers on a socket named after the project directory,
+// in a directory private to the user.
+// Requests are one line, "ss-daemon/1 <command> [arguments]", answered with "ok <size>" and a payload or "error <message>".
+// Every call fails quietly when no daemon is running so the tools can load from disk instead.
+class DaemonClient
+{
+public:
+	static constexpr const char* k_protocol = "ss-daemon/1";
+	static constexpr size_t k_maxLineLength = 4096;
+
+	DaemonClient(const std::filesystem::path& projPath) : m_projPath(projPath) {}
+
+	// Socket paths are limited to about 100 characters, so the project is hashed into the name
+	static std::filesystem::path SocketPath(const std::filesystem::path& projPath)
+	{
+		std::error_code error;
+		std::filesystem::path canonical = std::filesystem::weakly_canonical(projPath, error);
+		if (error)
+			canonical = projPath.lexically_normal();
+		if (!canonical.has_filename())
+			canonical = canonical.parent_path();
+		std::string name = canonical.generic_string();
+
+		// FNV-1a, std::hash is free to differ between the daemon and tool builds
+		uint64_t hash = 14695981039346656037ull;
+		for (const char c : name)
+		{
+			hash ^= (unsigned char)c;
+			hash *= 1099511628211ull;
+		}
+
+		char hex[17];
+		std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+		return LocalSocket::PrivateDirectory("ss-daemon") / (std::string(hex) + ".sock");
+	}
+
+	// false -> no daemon, or it did not answer with "ok"
+	bool Request(const std::string& request, std::string& payload)
+	{
+		// Format writes whatever comes back to disk, so only a daemon of the same user is trusted
+		std::filesystem::path socketPath = SocketPath(m_projPath);
+		LocalSocket socket;
+		if (!LocalSocket::IsPrivateDirectory(socketPath.parent_path()) || !socket.Connect(socketPath))
+			return false;
+
+		socket.SetTimeout(k_timeoutMs);
+		if (!socket.SendAll(std::string(k_protocol) + " " + request + "\n"))
+			return false;
+
+		std::string header;
+		if (!socket.ReceiveLine(header, k_maxLineLength) || header.rfind("ok ", 0) != 0)
+			return false;
+
+		unsigned long long size = std::strtoull(header.c_str() + 3, nullptr, 10);
+		if (size > k_maxPayload)
+			return false;
+
+		return socket.ReceiveExact((size_t)size, payload);
+	}
+
+	// The sequences [first, first + count), the whole project by default
+	bool Fetch(Project& proj, size_t first = 0, size_t count = SIZE_MAX)
+	{
+		std::string payload;
+		if (!Request("sequences " + std::to_string(first) + " " + std::to_string(count), payload))
+			return false;
+
+		return proj.Deserialize(m_projPath, payload);
+	}
+
+	// Only the diagnostics, 'proj' has to collect them
+	bool FetchDiagnostics(Project& proj)
+	{
+		std::string payload;
+		if (!Request("validate", payload))
+			return false;
+
+		return proj.Deserialize(m_projPath, payload);
+	}
+
+private:
+	// Long enough for the daemon to reparse a big project that just changed
+	static constexpr int k_timeoutMs = 10000;
+	static constexpr unsigned long long k_maxPayload = 1ull << 32;
+
+	std::filesystem::path m_projPath;
+};
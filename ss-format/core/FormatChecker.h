@@ -0,0 +1,180 @@
+#pragma once
+
+#include "ParallelFor.h"
+#include "Project.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+// Compares the formatted project with what is on disk without writing anything
+class FormatChecker
+{
+public:
+	void SetShowDiff(bool showDiff) { m_showDiff = showDiff; }
+	void SetWorkerCount(size_t count) { m_workerCount = count; }
+
+	// true -> project is already formatted
+	bool Check(Project& proj, const std::filesystem::path& projPath)
+	{
+		// The same plan Save would carry out, so a renumbered scene shows up as a rename and not as a new file
+		SavePlan plan = proj.PlanSave(projPath);
+
+		std::set<std::filesystem::path> overwritten(plan.touched.begin(), plan.touched.end());
+		std::vector<std::string> reports(plan.writes.size() + plan.removes.size());
+		ParallelFor(reports.size(), m_workerCount, [&](size_t i)
+			{
+				if (i < plan.writes.size())
+					reports[i] = CheckWrite(projPath, plan.writes[i], overwritten.find(plan.writes[i].path) != overwritten.end());
+				else
+					reports[i] = CheckRemove(projPath, plan.removes[i - plan.writes.size()]);
+			});
+
+		for (const SavePlan::Rename& rename : plan.renames)
+		{
+			std::cout << ((m_showDiff) ? "rename " : "Would rename: ") << rename.from.generic_string() << " -> " << rename.to.generic_string() << "\n";
+		}
+
+		for (const std::string& report : reports)
+		{
+			std::cout << report;
+		}
+
+		size_t changes = plan.renames.size() + reports.size();
+		if (changes == 0)
+		{
+			std::cout << "All " << plan.unchanged << " files are formatted" << std::endl;
+			return true;
+		}
+
+		std::cout << changes << " of " << plan.unchanged + changes << " files would change" << std::endl;
+		return false;
+	}
+
+private:
+	// 'isOverwrite' -> a file already at that path gets new contents, otherwise the file is new
+	std::string CheckWrite(const std::filesystem::path& projPath, const SavePlan::Write& write, bool isOverwrite)
+	{
+		if (!isOverwrite)
+			return (m_showDiff) ? Diff(write.path, "", write.contents) : "Would create: " + write.path.string() + "\n";
+
+		if (!m_showDiff)
+			return "Would reformat: " + write.path.string() + "\n";
+
+		return Diff(write.path, ReadFile(projPath / write.path), write.contents);
+	}
+
+	std::string CheckRemove(const std::filesystem::path& projPath, const std::filesystem::path& relPath)
+	{
+		if (!m_showDiff)
+			return "Would remove: " + relPath.string() + "\n";
+
+		return Diff(relPath, ReadFile(projPath / relPath), "");
+	}
+
+	std::string ReadFile(const std::filesystem::path& path)
+	{
+		std::ifstream file(path);
+		return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	}
+
+	std::vector<std::string> SplitLines(const std::string& str)
+	{
+		std::vector<std::string> result;
+		std::stringstream stream(str);
+		std::string line;
+		while (std::getline(stream, line))
+		{
+			result.push_back(line);
+		}
+		return result;
+	}
+
+	// Unified diff containing only the changed hunks
+	std::string Diff(const std::filesystem::path& relPath, const std::string& before, const std::string& after)
+	{
+		std::vector<std::string> a = SplitLines(before);
+		std::vector<std::string> b = SplitLines(after);
+
+		// Longest common subsequence table, scene files are small enough for the quadratic version
+		std::vector<std::vector<uint32_t>> lcs(a.size() + 1, std::vector<uint32_t>(b.size() + 1, 0));
+		for (size_t i = a.size(); i-- > 0;)
+		{
+			for (size_t j = b.size(); j-- > 0;)
+			{
+				lcs[i][j] = (a[i] == b[j]) ? lcs[i + 1][j + 1] + 1 : std::max(lcs[i + 1][j], lcs[i][j + 1]);
+			}
+		}
+
+		struct Edit
+		{
+			char op;
+			size_t aLine;
+			size_t bLine;
+		};
+
+		std::vector<Edit> edits;
+		size_t i = 0;
+		size_t j = 0;
+		while (i < a.size() || j < b.size())
+		{
+			if (i < a.size() && j < b.size() && a[i] == b[j])
+				edits.push_back({ ' ', i++, j++ });
+			else if (i < a.size() && (j == b.size() || lcs[i + 1][j] >= lcs[i][j + 1]))
+				edits.push_back({ '-', i++, j });
+			else
+				edits.push_back({ '+', i, j++ });
+		}
+
+		std::string result = "--- a/" + relPath.generic_string() + "\n+++ b/" + relPath.generic_string() + "\n";
+
+		size_t index = 0;
+		while (index < edits.size())
+		{
+			if (edits[index].op == ' ')
+			{
+				++index;
+				continue;
+			}
+
+			size_t begin = (index > k_context) ? index - k_context : 0;
+			size_t end = index;
+			size_t unchangedRun = 0;
+			while (end < edits.size() && unchangedRun <= k_context * 2)
+			{
+				unchangedRun = (edits[end].op == ' ') ? unchangedRun + 1 : 0;
+				++end;
+			}
+			end -= std::min(unchangedRun, end - index);
+			end = std::min(end + k_context, edits.size());
+
+			size_t aCount = 0;
+			size_t bCount = 0;
+			std::string body;
+			for (size_t e = begin; e < end; ++e)
+			{
+				const Edit& edit = edits[e];
+				if (edit.op != '+')
+					++aCount;
+				if (edit.op != '-')
+					++bCount;
+				body += edit.op + ((edit.op == '+') ? b[edit.bLine] : a[edit.aLine]) + "\n";
+			}
+
+			result += "@@ -" + std::to_string(edits[begin].aLine + ((aCount > 0) ? 1 : 0)) + "," + std::to_string(aCount)
+				+ " +" + std::to_string(edits[begin].bLine + ((bCount > 0) ? 1 : 0)) + "," + std::to_string(bCount) + " @@\n";
+			result += body;
+			index = end;
+		}
+
+		return result;
+	}
+
+	const size_t k_context = 3;
+
+	bool m_showDiff = false;
+	size_t m_workerCount = 0;
+};
@@ -0,0 +1,124 @@
+#include <iostream>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include "DaemonClient.h"
+#include "FormatChecker.h"
+#include "Project.h"
+#include "ProjectValidator.h"
+
+// std::stoul throws on text and strtoul alone accepts "-1" or "4x"
+static bool ParseCount(const char* str, size_t& value)
+{
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(str, &end, 10);
+    if (end == str || *end != '\0' || errno == ERANGE || str[0] == '-' || parsed > SIZE_MAX)
+        return false;
+
+    value = (size_t)parsed;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    bool doCheck = false;
+    bool showDiff = false;
+    bool doValidate = false;
+    bool asJson = false;
+    bool useDaemon = true;
+    size_t workers = 1;
+    bool hasWorkers = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--help") == 0)
+        {
+            std::cout << "SimpleScript - Format\n  Run in SimpleScript project root directory.\n\n  Options\n    --check -- Report files that are not formatted without writing, exits with 1 if any\n    --diff -- Same as --check but prints the changed hunks\n    --validate -- Report every problem in the project instead of stopping at the first, exits with 1 on errors\n    --json -- Print the --validate report as JSON\n    --jobs N -- Number of worker threads (0 = all cores, the default for --check, --diff and --validate)\n    --no-daemon -- Parse the project from disk even when ss-daemon is running\n\n";
+            return 0;
+        }
+        if (strcmp(argv[i], "--check") == 0)
+        {
+            doCheck = true;
+        }
+        else if (strcmp(argv[i], "--diff") == 0)
+        {
+            doCheck = true;
+            showDiff = true;
+        }
+        else if (strcmp(argv[i], "--validate") == 0)
+        {
+            doValidate = true;
+        }
+        else if (strcmp(argv[i], "--json") == 0)
+        {
+            asJson = true;
+        }
+        else if (strcmp(argv[i], "--no-daemon") == 0)
+        {
+            useDaemon = false;
+        }
+        else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        {
+            if (!ParseCount(argv[++i], workers))
+            {
+                std::cout << argv[i] << " -- was not a recognized number for --jobs" << std::endl;
+                return 2;
+            }
+            hasWorkers = true;
+        }
+        else
+        {
+            std::cout << argv[i] << " -- was not a recognized option" << std::endl;
+            return 2;
+        }
+    }
+
+#ifdef _DEBUG
+    std::filesystem::path projPath = std::filesystem::current_path() / "prj";
+#else
+    std::filesystem::path projPath = std::filesystem::current_path();
+#endif // _DEBUG
+
+    if (asJson && !doValidate)
+    {
+        std::cout << "--json -- only applies to --validate" << std::endl;
+        return 2;
+    }
+
+    if (doValidate)
+    {
+        ProjectValidator validator;
+        validator.SetJson(asJson);
+        validator.SetUseDaemon(useDaemon);
+        if (hasWorkers)
+            validator.SetWorkerCount(workers);
+        return (validator.Validate(projPath)) ? 0 : 1;
+    }
+
+    // Checking only reads, so it uses every core unless --jobs says otherwise
+    if (doCheck && !hasWorkers)
+        workers = 0;
+
+    Project proj;
+    proj.SetWorkerCount(workers);
+
+    // A running ss-daemon already has the project parsed
+    if (!useDaemon || !DaemonClient(projPath).Fetch(proj))
+        proj.Load(projPath);
+
+    if (!doCheck)
+    {
+        proj.Save(projPath);
+        return 0;
+    }
+
+    FormatChecker checker;
+    checker.SetShowDiff(showDiff);
+    checker.SetWorkerCount(workers);
+    return (checker.Check(proj, projPath)) ? 0 : 1;
+}
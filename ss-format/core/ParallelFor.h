@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Runs func(i) for every i in [0, count) on up to 'workers' threads. 0 workers uses every hardware thread.
+// Work is handed out one index at a time, so the caller must not rely on execution order.
+inline void ParallelFor(size_t count, size_t workers, const std::function<void(size_t)>& func)
+{
+	if (workers == 0)
+		workers = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	workers = std::min(workers, count);
+
+	if (workers <= 1)
+	{
+		for (size_t i = 0; i < count; ++i)
+			func(i);
+		return;
+	}
+
+	std::atomic<size_t> next = 0;
+	auto worker = [&]()
+	{
+		for (size_t i = next++; i < count; i = next++)
+			func(i);
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < workers; ++i)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (std::thread& thread : threads)
+		thread.join();
+}
@@ -0,0 +1,1117 @@
+#pragma once
+
+#include "AsciiTransform.h"
+#include "TextBlock.h"
+#include "Character.h"
+#include "Diagnostic.h"
+#include "LineScanner.h"
+#include "ParallelFor.h"
+#include "Wire.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif // _WIN32
+
+struct Sequence
+{
+	std::string name;
+	std::vector<TextBlock> blocks;
+};
+
+struct SavePlan
+{
+	struct Write
+	{
+		std::filesystem::path path;
+		std::string contents;
+	};
+
+	struct Rename
+	{
+		std::filesystem::path from;
+		std::filesystem::path to;
+	};
+
+	// All paths are relative to the project directory
+	std::vector<Write> writes;
+	std::vector<Rename> renames;
+	std::vector<std::filesystem::path> removes;
+	std::vector<std::filesystem::path> touched; // Existing files that will be overwritten or removed
+	std::vector<std::filesystem::path> directories;
+	std::vector<std::filesystem::path> oldDirectories;
+	size_t unchanged = 0;
+
+	bool IsEmpty() const { return writes.empty() && renames.empty() && removes.empty(); }
+};
+
+enum class BackupStrategy
+{
+	Move,	// Rename every touched file into '.backup'
+	Link,	// Hard link overwritten files, rename removed files
+	Copy	// Copy every touched file
+};
+
+enum class FsyncPolicy
+{
+	None,	// Leave flushing to the OS
+	PerFile	// Flush each file to disk before it replaces the original
+};
+
+struct BackupStats
+{
+	size_t filesMoved = 0;
+	size_t filesLinked = 0;
+	size_t filesCopied = 0;
+	uintmax_t bytesMoved = 0;
+	uintmax_t bytesLinked = 0;
+	uintmax_t bytesCopied = 0;
+};
+
+class Project
+{
+	struct SceneLoad
+	{
+		size_t sequence = 0;
+		std::filesystem::path path;
+		std::vector<TextBlock> blocks;
+		std::vector<Diagnostic> diagnostics;
+		size_t firstLine = 0; // Where the first block came from, only set while collecting diagnostics
+		size_t firstColumn = 0;
+	};
+
+	struct SceneSave
+	{
+		size_t sequence = 0;
+		size_t slugIndex = 0;
+		size_t fileNumber = 0;
+	};
+
+public:
+	void ForEach(std::function<bool(TextBlock&, TextBlock*)> callback)
+	{
+		for (Sequence& seq : m_sequences)
+		{
+			for (size_t i = 0; i < seq.blocks.size(); ++i)
+			{
+				TextBlock* next = (i < seq.blocks.size() - 1) ? &seq.blocks[i + 1] : nullptr;
+				if (callback(seq.blocks[i], next))
+					i++;
+			}
+		}
+	}
+
+	void MsgCallback(const std::function<void(const std::string&)> msgCallback) { m_print = msgCallback; }
+	// Threads used to parse, render and write scenes. 1 is serial, 0 uses every hardware thread.
+	void SetWorkerCount(const size_t count) { m_workerCount = count; }
+	void SetBackupStrategy(const BackupStrategy strategy) { m_backupStrategy = strategy; }
+	void SetFsyncPolicy(const FsyncPolicy policy) { m_fsyncPolicy = policy; }
+	const BackupStats& GetBackupStats() const { return m_backupStats; }
+	// Load keeps going past errors and records every problem instead of printing it
+	void SetCollectDiagnostics(const bool collect) { m_collectDiagnostics = collect; }
+	const std::vector<Diagnostic>& GetDiagnostics() const { return m_diagnostics; }
+
+	void Load(const std::filesystem::path& projDirectory)
+	{
+		if (!std::filesystem::exists(projDirectory))
+		{
+			if (m_collectDiagnostics)
+				m_diagnostics.push_back({ projDirectory, 0, 0, Severity::Error, "missing-project", "Project Directory does not exist" });
+			else
+				Print("Project Directory does not exist");
+			return;
+		}
+
+		if (std::filesystem::exists(projDirectory / "_char.txt"))
+		{
+			LoadCharacters(projDirectory / "_char.txt");
+		}
+		else
+		{
+			Report(m_diagnostics, { projDirectory / "_char.txt", 0, 0, Severity::Note, "missing-characters", "'_char.txt' was not found." });
+		}
+
+		std::vector<std::filesystem::path> sequencePaths;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(projDirectory))
+		{
+			if (entry.is_regular_file() || IsIgnoredDirectory(entry.path()))
+				continue;
+
+			sequencePaths.push_back(entry.path());
+		}
+		std::sort(sequencePaths.begin(), sequencePaths.end());
+
+		std::vector<SceneLoad> scenes;
+		for (const std::filesystem::path& sequencePath : sequencePaths)
+		{
+			LoadSequence(sequencePath, scenes);
+		}
+
+		// Scenes are parsed independently and stitched together in order afterwards
+		ParallelFor(scenes.size(), m_workerCount, [&](size_t i) { LoadScene(scenes[i]); });
+
+		for (SceneLoad& scene : scenes)
+		{
+			Sequence& seq = m_sequences[scene.sequence];
+
+			// Render would stop here, a sequence has to start with a slug
+			if (m_collectDiagnostics && seq.blocks.empty() && !scene.blocks.empty() && scene.blocks.front().type != TextBlock::Slug)
+				m_diagnostics.push_back({ scene.path, scene.firstLine, scene.firstColumn, Severity::Error, "sequence-without-slug", "Sequence doesn't begin with a slug line" });
+
+			seq.blocks.insert(seq.blocks.end(), std::make_move_iterator(scene.blocks.begin()), std::make_move_iterator(scene.blocks.end()));
+			for (Diagnostic& diagnostic : scene.diagnostics)
+			{
+				Report(m_diagnostics, std::move(diagnostic));
+			}
+		}
+	}
+
+	void Save(const std::filesystem::path& projPath)
+	{
+		SavePlan plan = PlanSave(projPath);
+		ApplySave(projPath, plan);
+
+		Print("Saved -- " + std::to_string(plan.writes.size()) + " written, "
+			+ std::to_string(plan.renames.size()) + " renamed, "
+			+ std::to_string(plan.removes.size()) + " removed, "
+			+ std::to_string(plan.unchanged) + " unchanged");
+	}
+
+	// Renders the project in memory and diffs it against what is on disk. Nothing is written.
+	SavePlan PlanSave(const std::filesystem::path& projPath)
+	{
+		SavePlan plan;
+
+		std::vector<SavePlan::Write> rendered = Render(plan.directories);
+		std::vector<std::filesystem::path> existingPaths = ListFiles(projPath, plan.oldDirectories);
+
+		std::vector<std::string> existingContents(existingPaths.size());
+		ParallelFor(existingPaths.size(), m_workerCount, [&](size_t i) { existingContents[i] = ReadFile(projPath / existingPaths[i]); });
+
+		std::map<std::filesystem::path, std::string> existing;
+		for (size_t i = 0; i < existingPaths.size(); ++i)
+		{
+			existing[existingPaths[i]] = std::move(existingContents[i]);
+		}
+
+		std::set<std::filesystem::path> targets;
+		for (const SavePlan::Write& write : rendered)
+		{
+			targets.insert(write.path);
+		}
+
+		// Files that already match are kept, everything else is a candidate rename source
+		std::set<std::filesystem::path> kept;
+		std::vector<bool> isDone(rendered.size(), false);
+		for (size_t i = 0; i < rendered.size(); ++i)
+		{
+			auto found = existing.find(rendered[i].path);
+			if (found != existing.end() && found->second == rendered[i].contents)
+			{
+				kept.insert(rendered[i].path);
+				isDone[i] = true;
+				++plan.unchanged;
+			}
+		}
+
+		std::unordered_map<std::string, std::vector<std::filesystem::path>> byContents;
+		for (auto& pair : existing)
+		{
+			if (kept.find(pair.first) == kept.end())
+				byContents[pair.second].push_back(pair.first);
+		}
+
+		std::set<std::filesystem::path> moved;
+		for (size_t i = 0; i < rendered.size(); ++i)
+		{
+			if (isDone[i])
+				continue;
+
+			auto found = byContents.find(rendered[i].contents);
+			if (found != byContents.end() && !found->second.empty())
+			{
+				plan.renames.push_back({ found->second.back(), rendered[i].path });
+				moved.insert(found->second.back());
+				found->second.pop_back();
+				continue;
+			}
+
+			plan.writes.push_back(std::move(rendered[i]));
+		}
+
+		for (auto& pair : existing)
+		{
+			if (kept.find(pair.first) != kept.end() || moved.find(pair.first) != moved.end())
+				continue;
+
+			// Overwritten by a write or rename, or no longer part of the project
+			plan.touched.push_back(pair.first);
+			if (targets.find(pair.first) == targets.end())
+				plan.removes.push_back(pair.first);
+		}
+
+		return plan;
+	}
+
+	// Renders every file Save would produce, with paths relative to the project directory
+	std::vector<SavePlan::Write> Render(std::vector<std::filesystem::path>& directories)
+	{
+		directories.clear();
+
+		// File numbers only depend on the number of slugs before a scene, so every scene can be rendered on its own
+		std::vector<SceneSave> scenes;
+		size_t fileCounter = 0;
+		for (size_t i = 0; i < m_sequences.size(); ++i)
+		{
+			const Sequence& seq = m_sequences[i];
+			if (!seq.blocks.empty() && seq.blocks.front().type != TextBlock::Slug)
+			{
+				Print("Fatal Error -- Sequence doesn't begin with a slug line");
+				exit(1);
+			}
+
+			for (size_t j = 0; j < seq.blocks.size(); ++j)
+			{
+				if (seq.blocks[j].type == TextBlock::Slug)
+					scenes.push_back({ i, j, fileCounter++ });
+			}
+		}
+
+		for (size_t i = 0; i < m_sequences.size(); ++i)
+		{
+			directories.push_back(PadNumber(i, 2) + "_" + m_sequences[i].name);
+		}
+
+		std::vector<SavePlan::Write> rendered(scenes.size() + 1);
+		rendered[0] = { "_char.txt", RenderCharacters() };
+		ParallelFor(scenes.size(), m_workerCount, [&](size_t i)
+			{
+				const SceneSave& scene = scenes[i];
+				const Sequence& seq = m_sequences[scene.sequence];
+				SavePlan::Write& write = rendered[i + 1];
+				write.path = directories[scene.sequence] / (PadNumber(scene.fileNumber, 3) + "_" + NameFromSlug(seq.blocks[scene.slugIndex].content) + ".txt");
+				RenderScene(seq, scene.slugIndex, write.contents);
+			});
+
+		return rendered;
+	}
+
+	// Script files currently in the project, with paths relative to the project directory
+	std::vector<std::filesystem::path> ListFiles(const std::filesystem::path& projPath, std::vector<std::filesystem::path>& directories)
+	{
+		directories.clear();
+
+		std::vector<std::filesystem::path> files;
+		if (std::filesystem::exists(projPath / "_char.txt"))
+		{
+			files.push_back("_char.txt");
+		}
+
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(projPath))
+		{
+			if (entry.is_regular_file() || IsIgnoredDirectory(entry.path()))
+				continue;
+
+			directories.push_back(entry.path().filename());
+			for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(entry.path()))
+			{
+				if (!file.is_regular_file() || file.path().extension() != ".txt")
+					continue;
+
+				files.push_back(entry.path().filename() / file.path().filename());
+			}
+		}
+
+		return files;
+	}
+
+	// Diagnostics, characters and the sequences [first, first + count) for ss-daemon clients, read back with Deserialize.
+	// Paths are sent relative to the project directory.
+	std::string Serialize(const std::filesystem::path& projPath, size_t first, size_t count) const
+	{
+		first = std::min(first, m_sequences.size());
+		count = std::min(count, m_sequences.size() - first);
+
+		std::string data;
+		WireWriter out(data);
+
+		// Scenes before the range, so part of a project keeps its scene numbers
+		size_t sceneOffset = 0;
+		for (size_t i = 0; i < first; ++i)
+		{
+			sceneOffset += std::count_if(m_sequences[i].blocks.begin(), m_sequences[i].blocks.end(), [](const TextBlock& block) { return block.type == TextBlock::Slug; });
+		}
+		out.U64(sceneOffset);
+
+		out.U64(m_diagnostics.size());
+		for (const Diagnostic& diagnostic : m_diagnostics)
+		{
+			out.U8((uint8_t)diagnostic.severity);
+			out.U64(diagnostic.line);
+			out.U64(diagnostic.column);
+			out.String(diagnostic.path.lexically_relative(projPath).generic_string());
+			out.String(diagnostic.code);
+			out.String(diagnostic.message);
+		}
+
+		out.U64(m_characters.data.size());
+		for (const Character& c : m_characters.data)
+		{
+			out.String(c.name);
+			out.String(c.notes);
+			out.U8(c.color.r);
+			out.U8(c.color.g);
+			out.U8(c.color.b);
+			out.U8(c.color.a);
+		}
+
+		out.U64(count);
+		for (size_t i = first; i < first + count; ++i)
+		{
+			out.String(m_sequences[i].name);
+			out.U64(m_sequences[i].blocks.size());
+			for (const TextBlock& block : m_sequences[i].blocks)
+			{
+				out.U8((uint8_t)block.type);
+				out.String(block.character);
+				out.String(block.content);
+			}
+		}
+
+		return data;
+	}
+
+	// Takes the place of Load with what Serialize wrote. false -> the data is damaged, or it has errors a normal
+	// load stops on, load from disk instead so they are reported the usual way.
+	bool Deserialize(const std::filesystem::path& projPath, std::string_view data)
+	{
+		WireReader in(data);
+		in.U64(); // Scene offset, ss-format always works on the whole project
+
+		std::vector<Diagnostic> diagnostics(in.Count(41));
+		for (Diagnostic& diagnostic : diagnostics)
+		{
+			uint8_t severity = in.U8();
+			if (severity > (uint8_t)Severity::Error)
+				return false;
+
+			diagnostic.severity = (Severity)severity;
+			diagnostic.line = in.U64();
+			diagnostic.column = in.U64();
+			diagnostic.path = projPath / std::filesystem::path(in.String());
+			diagnostic.code = in.String();
+			diagnostic.message = in.String();
+		}
+
+		CharacterCollection characters;
+		characters.data.resize(in.Count(20));
+		for (Character& c : characters.data)
+		{
+			c.name = in.String();
+			c.notes = in.String();
+			c.color.r = in.U8();
+			c.color.g = in.U8();
+			c.color.b = in.U8();
+			c.color.a = in.U8();
+		}
+
+		std::vector<Sequence> sequences(in.Count(16));
+		for (Sequence& seq : sequences)
+		{
+			seq.name = in.String();
+			seq.blocks.resize(in.Count(17));
+			for (TextBlock& block : seq.blocks)
+			{
+				// Render and Save switch on the type, anything they have no case for is damaged data
+				uint8_t type = in.U8();
+				if (type > TextBlock::Note)
+					return false;
+
+				block.type = (TextBlock::Type)type;
+				block.character = in.String();
+				block.content = in.String();
+			}
+		}
+
+		if (!in.IsValid() || !in.IsAtEnd())
+			return false;
+
+		if (!m_collectDiagnostics && std::any_of(diagnostics.begin(), diagnostics.end(), [](const Diagnostic& diagnostic) { return diagnostic.severity == Severity::Error; }))
+			return false;
+
+		for (Diagnostic& diagnostic : diagnostics)
+		{
+			Report(m_diagnostics, std::move(diagnostic));
+		}
+
+		m_sequences = std::move(sequences);
+		m_characters = std::move(characters);
+		return true;
+	}
+
+private:
+	void Print(const std::string& msg)
+	{
+		std::lock_guard<std::mutex> lock(m_printMutex);
+		if (m_print == nullptr)
+		{
+			std::cout << msg << std::endl;
+			return;
+		}
+
+		m_print(msg);
+	}
+
+	// Prints like loading always has and stops on errors, unless diagnostics are being collected
+	void Report(std::vector<Diagnostic>& diagnostics, Diagnostic diagnostic)
+	{
+		if (m_collectDiagnostics)
+		{
+			diagnostics.push_back(std::move(diagnostic));
+			return;
+		}
+
+		switch (diagnostic.severity)
+		{
+		case Severity::Note:
+			Print("Note -- " + diagnostic.message);
+			break;
+		case Severity::Warning:
+			Print(diagnostic.message);
+			break;
+		case Severity::Error:
+			Print("Fatal Error -- " + diagnostic.message);
+			exit(1);
+		}
+	}
+
+	void LoadCharacters(const std::filesystem::path& charPath)
+	{
+		LineScanner scanner;
+		scanner.Load(charPath);
+
+		LineLocator locator(scanner.GetText());
+		auto report = [&](const ScannedLine& scanned, Severity severity, const char* code, const std::string& message)
+		{
+			Diagnostic diagnostic{ charPath, 0, 0, severity, code, message };
+			locator.Locate(scanned.begin, diagnostic.line, diagnostic.column);
+			Report(m_diagnostics, std::move(diagnostic));
+		};
+
+		std::string charName = "";
+		Color charColor{};
+
+		for (const ScannedLine& scanned : scanner.GetLines())
+		{
+			std::string_view line = scanner.GetText(scanned);
+
+			if (scanned.kind == LineKind::Character)
+			{
+				size_t nameEnd = line.find_first_of(']');
+				size_t colBegin = line.find_first_of('{');
+				size_t colEnd = line.find_first_of('}');
+
+				Character* c = nullptr;
+
+				if (nameEnd == std::string::npos)
+				{
+					report(scanned, Severity::Warning, "unclosed-character", "No Character end point fount for line: " + std::string(line));
+					if (colBegin == std::string::npos)
+					{
+						charName = line.substr(1);
+					}
+					else
+					{
+						charName = line.substr(colBegin - 1);
+					}
+
+					ToCaps(charName);
+					Trim(charName);
+					c = &m_characters[charName];
+					c->name = charName;
+				}
+				else
+				{
+					charName = line.substr(1, nameEnd - 1);
+					ToCaps(charName);
+					Trim(charName);
+					c = &m_characters[charName];
+					c->name = charName;
+				}
+
+				if (colBegin == std::string::npos)
+				{
+					c->color = { 255, 255, 255, 255 };
+				}
+				else
+				{
+					std::stringstream colorStream;
+					if (colEnd == std::string::npos)
+					{
+						report(scanned, Severity::Warning, "unclosed-color", "No Color end point fount for line: " + std::string(line));
+						colorStream << line.substr(colBegin + 1);
+					}
+					else
+					{
+						colorStream << line.substr(colBegin + 1, colEnd - (colBegin + 1));
+					}
+					int count = 0;
+					std::string colCell;
+					while(std::getline(colorStream, colCell, ',') && count < 4)
+					{
+						Trim(colCell);
+						uint8_t* channel = nullptr;
+						switch (count)
+						{
+						case 0:
+							channel = &c->color.r;
+							break;
+						case 1:
+							channel = &c->color.g;
+							break;
+						case 2:
+							channel = &c->color.b;
+							break;
+						case 3:
+							channel = &c->color.a;
+							break;
+						default:
+							Print(std::string("count is larger than 4"));
+						}
+						try
+						{
+							*channel = (uint8_t)std::stoi(colCell);
+						}
+						catch (std::exception)
+						{
+							report(scanned, Severity::Warning, "invalid-color", "Could not parse color integer: " + colCell);
+							*channel = 255;
+						}
+						++count;
+					}
+
+					while (count < 4)
+					{
+						uint8_t* channel = nullptr;
+						switch (count)
+						{
+						case 0:
+							channel = &c->color.r;
+							break;
+						case 1:
+							channel = &c->color.g;
+							break;
+						case 2:
+							channel = &c->color.b;
+							break;
+						case 3:
+							channel = &c->color.a;
+							break;
+						}
+						*channel = 255;
+						++count;
+					}
+				}
+				continue;
+			}
+
+			// No special character
+			if (charName.empty())
+			{
+				report(scanned, Severity::Error, "note-without-character", "No current character name for line: " + std::string(line));
+				continue;
+			}
+
+			if (!m_characters[charName].notes.empty())
+			{
+				m_characters[charName].notes.append("\n").append(line);
+			}
+			else
+			{
+				m_characters[charName].notes = line;
+			}
+		}
+	}
+
+	void LoadSequence(const std::filesystem::path& sequencePath, std::vector<SceneLoad>& scenes)
+	{
+		std::string name = sequencePath.filename().string();
+		std::size_t underscoreIndex = name.find_first_of('_');
+		if (underscoreIndex != std::string::npos)
+		{
+			name = name.substr(underscoreIndex + 1);
+		}
+
+		Sequence& seq = m_sequences.emplace_back();
+		seq.name = name;
+
+		std::vector<std::filesystem::path> scenePaths;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(sequencePath))
+		{
+			if (!entry.is_regular_file() || entry.path().extension() != ".txt")
+				continue;
+
+			scenePaths.push_back(entry.path());
+		}
+		std::sort(scenePaths.begin(), scenePaths.end());
+
+		for (const std::filesystem::path& scenePath : scenePaths)
+		{
+			SceneLoad& scene = scenes.emplace_back();
+			scene.sequence = m_sequences.size() - 1;
+			scene.path = scenePath;
+		}
+	}
+
+	void LoadScene(SceneLoad& scene)
+	{
+		LineScanner scanner;
+		if (!scanner.Load(scene.path))
+		{
+			Report(scene.diagnostics, { scene.path, 0, 0, Severity::Warning, "unreadable-file", "Could not open file: " + scene.path.string() });
+			return;
+		}
+
+		LineLocator locator(scanner.GetText());
+		auto report = [&](const ScannedLine& scanned, Severity severity, const char* code, const std::string& message)
+		{
+			Diagnostic diagnostic{ scene.path, 0, 0, severity, code, message };
+			locator.Locate(scanned.begin, diagnostic.line, diagnostic.column);
+
+			// exit() on a worker would run static destructors while the others still parse, Load reports it after the join
+			if (!m_collectDiagnostics && severity == Severity::Error)
+				scene.diagnostics.push_back(std::move(diagnostic));
+			else
+				Report(scene.diagnostics, std::move(diagnostic));
+		};
+
+		std::vector<TextBlock>& blocks = scene.blocks;
+		auto addBlock = [&](const ScannedLine& scanned, TextBlock::Type type) -> TextBlock&
+		{
+			if (m_collectDiagnostics && blocks.empty())
+				locator.Locate(scanned.begin, scene.firstLine, scene.firstColumn);
+
+			TextBlock& block = blocks.emplace_back();
+			block.type = type;
+			return block;
+		};
+
+		std::string lastCharacter = "";
+
+		for (const ScannedLine& scanned : scanner.GetLines())
+		{
+			std::string_view line = scanner.GetText(scanned);
+
+			if (scanned.kind == LineKind::Slug)
+			{
+				TextBlock& block = addBlock(scanned, TextBlock::Slug);
+				block.content = LineScanner::Trim(line.substr(1));
+				ToCaps(block.content);
+				continue;
+			}
+			if (scanned.kind == LineKind::Character)
+			{
+				size_t closeIndex = line.find_first_of(']');
+				if (closeIndex == std::string::npos)
+				{
+					report(scanned, Severity::Warning, "unclosed-character", "Expecting close bracket for character specifier on line: " + std::string(line));
+					lastCharacter = line.substr(1);
+					ToCaps(lastCharacter);
+					continue;
+				}
+				lastCharacter = LineScanner::Trim(line.substr(1, closeIndex - 1));
+				ToCaps(lastCharacter);
+				continue;
+			}
+			if (scanned.kind == LineKind::Action)
+			{
+				TextBlock& block = addBlock(scanned, TextBlock::Action);
+				block.content = LineScanner::Trim(line.substr(1));
+				continue;
+			}
+			if (scanned.kind == LineKind::Parenthetical)
+			{
+				if (lastCharacter.empty())
+				{
+					report(scanned, Severity::Error, "parenthetical-without-character", "No Character assigned for parenthetical: " + std::string(line));
+					continue;
+				}
+
+				TextBlock& block = addBlock(scanned, TextBlock::Parenthetical);
+				block.character = lastCharacter;
+
+				size_t endIndex = line.find_last_of(')');
+				if (endIndex == std::string::npos)
+				{
+					report(scanned, Severity::Warning, "unclosed-parenthetical", "Expecting close parethesis for character specifier on line: " + std::string(line));
+					block.content = LineScanner::Trim(line.substr(1));
+					continue;
+				}
+
+				block.content = LineScanner::Trim(line.substr(1, endIndex - 1));
+
+				continue;
+			}
+			if (scanned.kind == LineKind::Note)
+			{
+				std::string_view note = LineScanner::Trim(line.substr(2));
+				if (!note.empty())
+				{
+				    TextBlock& block = addBlock(scanned, TextBlock::Note);
+					block.content = note;
+				}
+				continue;
+			}
+
+			if (lastCharacter.empty())
+			{
+				report(scanned, Severity::Error, "dialogue-without-character", "No Character assigned for dialogue: " + std::string(line));
+				continue;
+			}
+
+			TextBlock& block = addBlock(scanned, TextBlock::Dialogue);
+			block.character = lastCharacter;
+			block.content = line;
+		}
+	}
+
+	bool IsIgnoredDirectory(const std::filesystem::path& path)
+	{
+#ifdef _DEBUG
+		if (path.filename() == "int")
+			return true;
+#endif // _DEBUG
+
+		if (path.filename() == ".git")
+			return true;
+
+		if (path.filename() == ".backup")
+			return true;
+
+		return false;
+	}
+
+	std::string ReadFile(const std::filesystem::path& path)
+	{
+		std::ifstream file(path);
+		std::stringstream contents;
+		contents << file.rdbuf();
+		return contents.str();
+	}
+
+	// false -> the file could not be created, nothing was written
+	bool WriteFile(const std::filesystem::path& path, const std::string& contents)
+	{
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp";
+
+#ifdef _WIN32
+		// Keep the CRLF line endings text mode streams used to write
+		std::string buffer;
+		buffer.reserve(contents.size() + std::count(contents.begin(), contents.end(), '\n'));
+		for (const char c : contents)
+		{
+			if (c == '\n')
+				buffer.push_back('\r');
+			buffer.push_back(c);
+		}
+		FILE* file = _wfopen(tempPath.c_str(), L"wb");
+#else
+		const std::string& buffer = contents;
+		FILE* file = fopen(tempPath.c_str(), "wb");
+#endif // _WIN32
+
+		if (file == nullptr)
+			return false;
+
+		// Unbuffered so the whole file goes out in a single write
+		setvbuf(file, nullptr, _IONBF, 0);
+		fwrite(buffer.data(), 1, buffer.size(), file);
+
+		if (m_fsyncPolicy == FsyncPolicy::PerFile)
+		{
+#ifdef _WIN32
+			_commit(_fileno(file));
+#else
+			fsync(fileno(file));
+#endif // _WIN32
+		}
+		fclose(file);
+
+		std::filesystem::rename(tempPath, path);
+		return true;
+	}
+
+	void ApplySave(const std::filesystem::path& projPath, const SavePlan& plan)
+	{
+		if (!plan.touched.empty())
+		{
+			NewBackup(projPath, plan);
+		}
+
+		for (const std::filesystem::path& dir : plan.directories)
+		{
+			std::filesystem::create_directories(projPath / dir);
+		}
+
+		// Renames are staged so that files can swap or shift names without clobbering each other
+		std::vector<std::filesystem::path> staged;
+		for (const SavePlan::Rename& rename : plan.renames)
+		{
+			std::filesystem::path stagedPath = projPath / rename.to;
+			stagedPath += ".rename";
+			std::filesystem::rename(projPath / rename.from, stagedPath);
+			staged.push_back(stagedPath);
+		}
+
+		for (const std::filesystem::path& path : plan.removes)
+		{
+			std::filesystem::remove(projPath / path);
+		}
+
+		std::vector<char> isWritten(plan.writes.size(), 0);
+		ParallelFor(plan.writes.size(), m_workerCount, [&](size_t i) { isWritten[i] = WriteFile(projPath / plan.writes[i].path, plan.writes[i].contents); });
+
+		// Reported here rather than on the worker, exit() there would race the writes still running
+		for (size_t i = 0; i < plan.writes.size(); ++i)
+		{
+			if (isWritten[i])
+				continue;
+
+			std::filesystem::path tempPath = projPath / plan.writes[i].path;
+			tempPath += ".tmp";
+			Print("Fatal Error -- Could not write file: " + tempPath.string());
+			exit(1);
+		}
+
+		for (size_t i = 0; i < plan.renames.size(); ++i)
+		{
+			std::filesystem::rename(staged[i], projPath / plan.renames[i].to);
+		}
+
+		for (const std::filesystem::path& dir : plan.oldDirectories)
+		{
+			if (std::find(plan.directories.begin(), plan.directories.end(), dir) != plan.directories.end())
+				continue;
+
+			if (std::filesystem::is_empty(projPath / dir))
+			{
+				std::filesystem::remove(projPath / dir);
+			}
+			else
+			{
+				Print("Note -- '" + dir.string() + "' still contains non-script files and was not removed");
+			}
+		}
+	}
+
+	void NewBackup(const std::filesystem::path& projPath, const SavePlan& plan)
+	{
+		m_backupStats = BackupStats();
+
+		if (std::filesystem::exists(projPath / ".backup"))
+		{
+			std::filesystem::remove_all(projPath / ".backup");
+		}
+		std::filesystem::create_directories(projPath / ".backup");
+
+		for (const std::filesystem::path& path : plan.touched)
+		{
+			std::filesystem::path source = projPath / path;
+			std::filesystem::path dest = projPath / ".backup" / path;
+			std::filesystem::create_directories(dest.parent_path());
+
+			std::error_code ec;
+			uintmax_t size = std::filesystem::file_size(source, ec);
+			if (ec)
+				size = 0;
+
+			// Removed files are never read again, overwritten files are replaced by rename so a link keeps the old contents
+			bool isRemoved = std::find(plan.removes.begin(), plan.removes.end(), path) != plan.removes.end();
+			if (m_backupStrategy == BackupStrategy::Move || (m_backupStrategy == BackupStrategy::Link && isRemoved))
+			{
+				std::filesystem::rename(source, dest, ec);
+				if (!ec)
+				{
+					++m_backupStats.filesMoved;
+					m_backupStats.bytesMoved += size;
+					continue;
+				}
+			}
+			else if (m_backupStrategy == BackupStrategy::Link)
+			{
+				std::filesystem::create_hard_link(source, dest, ec);
+				if (!ec)
+				{
+					++m_backupStats.filesLinked;
+					m_backupStats.bytesLinked += size;
+					continue;
+				}
+			}
+
+			// Fallback for filesystems without hard links or backups on another volume
+			std::filesystem::copy_file(source, dest, std::filesystem::copy_options::overwrite_existing);
+			++m_backupStats.filesCopied;
+			m_backupStats.bytesCopied += size;
+		}
+
+		Print("Backup -- " + std::to_string(m_backupStats.filesMoved) + " moved (" + std::to_string(m_backupStats.bytesMoved) + " bytes), "
+			+ std::to_string(m_backupStats.filesLinked) + " linked (" + std::to_string(m_backupStats.bytesLinked) + " bytes), "
+			+ std::to_string(m_backupStats.filesCopied) + " copied (" + std::to_string(m_backupStats.bytesCopied) + " bytes)");
+	}
+
+	std::string RenderCharacters()
+	{
+		size_t size = 0;
+		for (const Character& c : m_characters.data)
+		{
+			size += c.name.length() + c.notes.length() + 32;
+		}
+
+		std::string result;
+		result.reserve(size);
+
+		for (const Character& c : m_characters.data)
+		{
+			result.append(1, '[').append(c.name).append("]{ ")
+				.append(std::to_string((int)c.color.r)).append(", ")
+				.append(std::to_string((int)c.color.g)).append(", ")
+				.append(std::to_string((int)c.color.b)).append(", ")
+				.append(std::to_string((int)c.color.a)).append(" }\n");
+
+			if (c.notes.empty())
+			{
+				result.append(1, '\n');
+				continue;
+			}
+
+			result.append(c.notes).append("\n\n");
+		}
+
+		return result;
+	}
+
+	void RenderScene(const Sequence& seq, size_t slugIndex, std::string& file)
+	{
+		file.reserve(SceneSize(seq, slugIndex));
+		file.append("# ").append(seq.blocks[slugIndex].content).append("\n\n");
+
+		std::string lastCharName = "";
+		for (size_t i = slugIndex + 1; i < seq.blocks.size() && seq.blocks[i].type != TextBlock::Slug; ++i)
+		{
+			const TextBlock& block = seq.blocks[i];
+			switch (block.type)
+			{
+			case TextBlock::Action:
+				file.append("* ").append(block.content).append("\n\n");
+				break;
+			case TextBlock::Note:
+				file.append("// ").append(block.content).append("\n\n");
+				break;
+			case TextBlock::Parenthetical:
+				if (block.character != lastCharName)
+				{
+					file.append(1, '[').append(block.character).append("]\n");
+					lastCharName = block.character;
+				}
+				file.append(1, '(').append(block.content).append(")\n\n");
+				break;
+			case TextBlock::Dialogue:
+				if (block.character != lastCharName)
+				{
+					file.append(1, '[').append(block.character).append("]\n");
+					lastCharName = block.character;
+				}
+				file.append(block.content).append("\n\n");
+				break;
+			default:
+				Print(std::string("Save Sequence -- `TextBlock` enum not implemented"));
+				break;
+			}
+		}
+	}
+
+	// Upper bound of the rendered size of the scene starting at 'slugIndex'
+	size_t SceneSize(const Sequence& seq, size_t slugIndex)
+	{
+		size_t size = seq.blocks[slugIndex].content.length() + 4;
+		for (size_t i = slugIndex + 1; i < seq.blocks.size() && seq.blocks[i].type != TextBlock::Slug; ++i)
+		{
+			size += seq.blocks[i].content.length() + seq.blocks[i].character.length() + 8;
+		}
+		return size;
+	}
+
+	void Trim(std::string& str)
+	{
+		std::string_view trimmed = LineScanner::Trim(str);
+		str.erase(trimmed.data() - str.data() + trimmed.size());
+		str.erase(0, trimmed.data() - str.data());
+	}
+
+	void ToCaps(std::string& str)
+	{
+		AsciiTransform::ToUpper(str.data(), str.size());
+	}
+
+	std::string PadNumber(size_t val, size_t digits)
+	{
+		std::string result = std::to_string(val);
+		if (result.length() < digits)
+			result.insert(0, digits - result.length(), '0');
+
+		return result;
+	}
+
+	std::string NameFromSlug(std::string_view line)
+	{
+		// Never longer than the slug, runs of special characters only shrink it
+		std::string result(line.size(), '\0');
+		result.resize(AsciiTransform::NameFromSlug(line.data(), line.size(), result.data()));
+		return result;
+	}
+
+private:
+	struct CharacterCollection
+	{
+		std::vector<Character> data;
+		Character& operator[](std::string name)
+		{
+			auto result = std::find_if(data.begin(), data.end(), [&](const Character& c) { return c.name == name; });
+			if (result == data.end())
+			{
+				Character& newEntry = data.emplace_back();
+				newEntry.name = name;
+				return newEntry;
+			}
+			return *result;
+		}
+	};
+
+	std::vector<Sequence> m_sequences;
+	CharacterCollection m_characters;
+	std::function<void(const std::string&)> m_print = nullptr;
+	std::mutex m_printMutex;
+	size_t m_workerCount = 1;
+	BackupStrategy m_backupStrategy = BackupStrategy::Link;
+	FsyncPolicy m_fsyncPolicy = FsyncPolicy::None;
+	BackupStats m_backupStats;
+	bool m_collectDiagnostics = false;
+	std::vector<Diagnostic> m_diagnostics;
+};
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "DaemonClient.h"
+#include "Diagnostic.h"
+#include "Project.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Loads the project without stopping at the first error and reports every problem it found
+class ProjectValidator
+{
+public:
+	void SetJson(bool json) { m_json = json; }
+	void SetWorkerCount(size_t count) { m_workerCount = count; }
+	void SetUseDaemon(bool useDaemon) { m_useDaemon = useDaemon; }
+
+	// true -> no errors, notes and warnings do not fail the project
+	bool Validate(const std::filesystem::path& projPath)
+	{
+		Project proj;
+		proj.SetWorkerCount(m_workerCount);
+		proj.SetCollectDiagnostics(true);
+		if (!m_useDaemon || !DaemonClient(projPath).FetchDiagnostics(proj))
+			proj.Load(projPath);
+
+		std::vector<Diagnostic> diagnostics = proj.GetDiagnostics();
+		for (Diagnostic& diagnostic : diagnostics)
+		{
+			std::filesystem::path relative = diagnostic.path.lexically_relative(projPath);
+			if (!relative.empty())
+				diagnostic.path = relative;
+		}
+
+		// Scenes are parsed in parallel, sorting keeps the report the same from run to run
+		std::sort(diagnostics.begin(), diagnostics.end(), [](const Diagnostic& a, const Diagnostic& b)
+			{
+				return std::tie(a.path, a.line, a.column, a.code) < std::tie(b.path, b.line, b.column, b.code);
+			});
+
+		size_t counts[3] = {};
+		for (const Diagnostic& diagnostic : diagnostics)
+		{
+			++counts[(size_t)diagnostic.severity];
+		}
+
+		if (m_json)
+			WriteJson(diagnostics, counts);
+		else
+			WriteText(diagnostics, counts);
+
+		return counts[(size_t)Severity::Error] == 0;
+	}
+
+private:
+	static const char* SeverityName(Severity severity)
+	{
+		switch (severity)
+		{
+		case Severity::Note: return "note";
+		case Severity::Warning: return "warning";
+		default: return "error";
+		}
+	}
+
+	// file:line:column: severity [code] message, like compilers print them
+	void WriteText(const std::vector<Diagnostic>& diagnostics, const size_t counts[3])
+	{
+		for (const Diagnostic& diagnostic : diagnostics)
+		{
+			std::cout << diagnostic.path.generic_string();
+			if (diagnostic.line > 0)
+				std::cout << ":" << diagnostic.line << ":" << diagnostic.column;
+
+			std::cout << ": " << SeverityName(diagnostic.severity) << " [" << diagnostic.code << "] " << diagnostic.message << "\n";
+		}
+
+		std::cout << counts[(size_t)Severity::Error] << " errors, " << counts[(size_t)Severity::Warning] << " warnings, "
+			<< counts[(size_t)Severity::Note] << " notes" << std::endl;
+	}
+
+	void WriteJson(const std::vector<Diagnostic>& diagnostics, const size_t counts[3])
+	{
+		std::cout << "{\n  \"errors\": " << counts[(size_t)Severity::Error] << ",\n  \"warnings\": " << counts[(size_t)Severity::Warning]
+			<< ",\n  \"notes\": " << counts[(size_t)Severity::Note] << ",\n  \"diagnostics\": [";
+		for (size_t i = 0; i < diagnostics.size(); ++i)
+		{
+			const Diagnostic& diagnostic = diagnostics[i];
+			std::cout << ((i == 0) ? "\n" : ",\n")
+				<< "    { \"file\": \"" << Escape(diagnostic.path.generic_string()) << "\", \"line\": " << diagnostic.line
+				<< ", \"column\": " << diagnostic.column << ", \"severity\": \"" << SeverityName(diagnostic.severity)
+				<< "\", \"code\": \"" << diagnostic.code << "\", \"message\": \"" << Escape(diagnostic.message) << "\" }";
+		}
+		std::cout << ((diagnostics.empty()) ? "]\n}" : "\n  ]\n}") << std::endl;
+	}
+
+	// Script lines go into messages as they are, so quotes, backslashes and control characters need escaping
+	static std::string Escape(const std::string& str)
+	{
+		std::string result;
+		result.reserve(str.size());
+		for (const char c : str)
+		{
+			switch (c)
+			{
+			case '"': result.append("\\\""); break;
+			case '\\': result.append("\\\\"); break;
+			case '\n': result.append("\\n"); break;
+			case '\r': result.append("\\r"); break;
+			case '\t': result.append("\\t"); break;
+			default:
+				if ((unsigned char)c < 0x20)
+				{
+					char code[8];
+					std::snprintf(code, sizeof(code), "\\u%04x", (unsigned char)c);
+					result.append(code);
+				}
+				else
+				{
+					result.push_back(c);
+				}
+			}
+		}
+		return result;
+	}
+
+	bool m_json = false;
+	size_t m_workerCount = 0;
+	bool m_useDaemon = true;
+};
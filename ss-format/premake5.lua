@@ -33,6 +33,46 @@ project "core"
 		systemversion "latest"
 		defines { "WIN32" }
 
+    filter "system:linux"
+        links { "pthread" }
+
+	filter "configurations:Debug"
+		defines { "_DEBUG", "_CONSOLE" }
+		symbols "On"
+
+    filter "configurations:Release"
+		defines { "NDEBUG", "_CONSOLE" }
+		optimize "On"
+
+project "bench"
+    location "%{prj.name}"
+    kind "ConsoleApp"
+    language "C++"
+    targetname "%{prj.name}"
+    targetdir ("bin/".. outputdir)
+    objdir ("%{prj.name}/int/" .. outputdir)
+    cppdialect "C++17"
+    staticruntime "Off"
+
+    files
+    {
+        "%{prj.name}/**.h",
+        "%{prj.name}/**.cpp"
+    }
+
+    includedirs
+    {
+        "core",
+        "../ss-gen/core"
+    }
+
+    filter "system:windows"
+		systemversion "latest"
+		defines { "WIN32" }
+
+    filter "system:linux"
+        links { "pthread" }
+
 	filter "configurations:Debug"
 		defines { "_DEBUG", "_CONSOLE" }
 		symbols "On"
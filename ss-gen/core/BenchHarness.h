@@ -0,0 +1,196 @@
+#pragma once
+
+// Timing, allocation counting and peak memory for the bench targets.
+// Replaces the global operator new, include it from exactly one translation unit.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <new>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+static std::atomic<size_t> g_benchAllocations{ 0 };
+static std::atomic<size_t> g_benchAllocatedBytes{ 0 };
+
+void* operator new(size_t size)
+{
+	g_benchAllocations.fetch_add(1, std::memory_order_relaxed);
+	g_benchAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+	void* ptr = std::malloc((size == 0) ? 1 : size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+struct BenchResult
+{
+	std::string name;
+	std::string size;
+	std::vector<double> runsMs;
+	double medianMs = 0.0;
+	size_t allocations = 0; // Of the last run
+	size_t bytes = 0;
+	size_t peakRssKb = 0; // Process wide high water mark after the last run
+	size_t bytesProcessed = 0; // Per run, set with SetBytesProcessed to report throughput
+};
+
+// --repeat=N --sizes=small,medium,huge --out=path
+struct BenchOptions
+{
+	size_t repeat = 5;
+	std::vector<std::string> sizes = { "small", "medium", "huge" };
+	std::string out; // Empty -> stdout
+
+	// false if an argument is not recognised
+	bool Parse(int argc, char* argv[])
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			if (arg.rfind("--repeat=", 0) == 0)
+			{
+				repeat = std::strtoul(arg.c_str() + 9, nullptr, 10);
+			}
+			else if (arg.rfind("--sizes=", 0) == 0)
+			{
+				sizes.clear();
+				std::string list = arg.substr(8);
+				size_t start = 0;
+				while (start <= list.length())
+				{
+					size_t end = std::min(list.find(',', start), list.length());
+					if (end > start)
+						sizes.push_back(list.substr(start, end - start));
+					start = end + 1;
+				}
+			}
+			else if (arg.rfind("--out=", 0) == 0)
+			{
+				out = arg.substr(6);
+			}
+			else
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+class BenchHarness
+{
+public:
+	BenchHarness(const std::string& suite, size_t repeat) : m_suite(suite), m_repeat(std::max<size_t>(repeat, 1)) {}
+
+	// setup runs before every repetition and is not measured
+	const BenchResult& Run(const std::string& name, const std::string& size, const std::function<void()>& setup, const std::function<void()>& func)
+	{
+		BenchResult result;
+		result.name = name;
+		result.size = size;
+
+		for (size_t i = 0; i < m_repeat; ++i)
+		{
+			if (setup)
+				setup();
+
+			size_t allocations = g_benchAllocations.load(std::memory_order_relaxed);
+			size_t bytes = g_benchAllocatedBytes.load(std::memory_order_relaxed);
+			auto start = std::chrono::steady_clock::now();
+
+			func();
+
+			result.runsMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			result.allocations = g_benchAllocations.load(std::memory_order_relaxed) - allocations;
+			result.bytes = g_benchAllocatedBytes.load(std::memory_order_relaxed) - bytes;
+		}
+
+		std::vector<double> sorted = result.runsMs;
+		std::sort(sorted.begin(), sorted.end());
+		result.medianMs = (sorted.size() % 2 == 1)
+			? sorted[sorted.size() / 2]
+			: (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2.0;
+		result.peakRssKb = PeakRssKb();
+
+		m_results.push_back(result);
+		return m_results.back();
+	}
+
+	// Reports GB/s for the last result
+	void SetBytesProcessed(size_t bytes)
+	{
+		if (!m_results.empty())
+			m_results.back().bytesProcessed = bytes;
+	}
+
+	void WriteJson(std::ostream& out) const
+	{
+		out << std::fixed << std::setprecision(3);
+		out << "{\n  \"suite\": \"" << m_suite << "\",\n  \"repeat\": " << m_repeat << ",\n  \"results\": [";
+		for (size_t i = 0; i < m_results.size(); ++i)
+		{
+			const BenchResult& result = m_results[i];
+			out << ((i == 0) ? "\n" : ",\n")
+				<< "    { \"name\": \"" << result.name << "\", \"size\": \"" << result.size
+				<< "\", \"ms\": " << result.medianMs << ", \"runsMs\": [";
+			for (size_t r = 0; r < result.runsMs.size(); ++r)
+			{
+				out << ((r == 0) ? "" : ", ") << result.runsMs[r];
+			}
+			out << "], \"allocations\": " << result.allocations << ", \"bytes\": " << result.bytes
+				<< ", \"peakRssKb\": " << result.peakRssKb;
+			if (result.bytesProcessed > 0 && result.medianMs > 0.0)
+				out << ", \"gbPerSecond\": " << result.bytesProcessed / (result.medianMs * 1e6);
+			out << " }";
+		}
+		out << "\n  ]\n}" << std::endl;
+	}
+
+	static size_t PeakRssKb()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return 0;
+
+		return counters.PeakWorkingSetSize / 1024;
+#else
+		rusage usage{};
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+			return 0;
+
+		// Kilobytes on Linux, bytes on macOS
+#ifdef __APPLE__
+		return (size_t)usage.ru_maxrss / 1024;
+#else
+		return (size_t)usage.ru_maxrss;
+#endif
+#endif
+	}
+
+private:
+	std::string m_suite;
+	size_t m_repeat;
+	std::vector<BenchResult> m_results;
+};
@@ -0,0 +1,108 @@
+#include <iostream>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "ProjectGenerator.h"
+
+int main(int argc, char* argv[])
+{
+    GeneratorOptions options;
+    std::filesystem::path output;
+    bool force = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--help") == 0)
+        {
+            std::cout << "SimpleScript - Generate\n  Writes a synthetic project for benchmarks.\n\n  Usage\n    ss-gen <output directory> [options]\n\n  Options\n"
+                "    --preset small|medium|huge -- Sets the sequence, scene and character counts\n"
+                "    --sequences N -- Number of sequence folders\n"
+                "    --scenes N -- Total number of scenes\n"
+                "    --characters N -- Number of characters in _char.txt\n"
+                "    --blocks N -- Average blocks per scene\n"
+                "    --dialogue-ratio F -- Share of blocks that are dialogue (0-1)\n"
+                "    --words N -- Average words per line\n"
+                "    --words-spread N -- Maximum distance from the average\n"
+                "    --seed N -- Same seed and options always give the same files\n"
+                "    --messy -- Loose formatting so ss-format has to rewrite every file\n"
+                "    --force -- Write into a directory that is not empty\n\n";
+            return 0;
+        }
+        if (strcmp(argv[i], "--preset") == 0 && hasValue)
+        {
+            if (!options.SetPreset(argv[++i]))
+            {
+                std::cout << argv[i] << " -- was not a recognized preset" << std::endl;
+                return 2;
+            }
+        }
+        else if (strcmp(argv[i], "--sequences") == 0 && hasValue)
+        {
+            options.sequences = std::stoul(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--scenes") == 0 && hasValue)
+        {
+            options.scenes = std::stoul(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--characters") == 0 && hasValue)
+        {
+            options.characters = std::stoul(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--blocks") == 0 && hasValue)
+        {
+            options.blocksPerScene = std::stoul(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--dialogue-ratio") == 0 && hasValue)
+        {
+            options.dialogueRatio = std::stof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--words") == 0 && hasValue)
+        {
+            options.wordsMean = std::stoul(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--words-spread") == 0 && hasValue)
+        {
+            options.wordsSpread = std::stoul(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            options.seed = std::stoull(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--messy") == 0)
+        {
+            options.messy = true;
+        }
+        else if (strcmp(argv[i], "--force") == 0)
+        {
+            force = true;
+        }
+        else if (argv[i][0] != '-' && output.empty())
+        {
+            output = argv[i];
+        }
+        else
+        {
+            std::cout << argv[i] << " -- was not a recognized option" << std::endl;
+            return 2;
+        }
+    }
+
+    if (output.empty())
+    {
+        std::cout << "No output directory given, see --help" << std::endl;
+        return 2;
+    }
+
+    if (std::filesystem::exists(output) && !std::filesystem::is_empty(output) && !force)
+    {
+        std::cout << output.string() << " -- is not empty, use --force to write into it anyway" << std::endl;
+        return 1;
+    }
+
+    GeneratorStats stats = ProjectGenerator(options).Generate(output);
+    std::cout << "Generated -- " << stats.files << " files, " << stats.blocks << " blocks, " << stats.bytes << " bytes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct GeneratorOptions
+{
+	size_t sequences = 10;
+	size_t scenes = 300; // Spread evenly over the sequences
+	size_t characters = 12;
+	size_t blocksPerScene = 16; // Average number of blocks after the slug line
+	float dialogueRatio = 0.6f; // Share of those blocks that are dialogue, the rest is action
+	float parentheticalRatio = 0.15f; // Share of dialogue blocks that get a parenthetical first
+	float noteRatio = 0.02f;
+	size_t wordsMean = 12; // Words per line, uniform sum around the mean
+	size_t wordsSpread = 8;
+	uint64_t seed = 1;
+	bool messy = false; // Loose formatting and placeholder file names so ss-format has to rewrite everything
+
+	// small, medium or huge, false if the name is unknown
+	bool SetPreset(const std::string& name)
+	{
+		if (name == "small")
+		{
+			sequences = 3;
+			scenes = 30;
+			characters = 6;
+		}
+		else if (name == "medium")
+		{
+			sequences = 10;
+			scenes = 300;
+			characters = 12;
+		}
+		else if (name == "huge")
+		{
+			sequences = 40;
+			scenes = 4000;
+			characters = 40;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+};
+
+struct GeneratorStats
+{
+	size_t files = 0;
+	size_t bytes = 0;
+	size_t blocks = 0;
+};
+
+// Writes a synthetic project in the layout Project::Load expects. The output only depends on the options,
+// the random source and distributions are implemented here so every platform produces the same bytes.
+class ProjectGenerator
+{
+	class Random
+	{
+	public:
+		Random(uint64_t seed) : m_state(seed) {}
+
+		// splitmix64
+		uint64_t Next()
+		{
+			uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+		// Inclusive
+		size_t Range(size_t min, size_t max)
+		{
+			return min + (size_t)(Next() % (uint64_t)(max - min + 1));
+		}
+
+		bool Chance(float probability)
+		{
+			return (Next() >> 40) < (uint64_t)(probability * (float)(1ull << 24));
+		}
+
+		template <typename T, size_t N>
+		const T& Pick(const T(&values)[N])
+		{
+			return values[Range(0, N - 1)];
+		}
+
+	private:
+		uint64_t m_state;
+	};
+
+public:
+	ProjectGenerator(const GeneratorOptions& options) : m_options(options), m_random(options.seed) {}
+
+	GeneratorStats Generate(const std::filesystem::path& root)
+	{
+		m_stats = GeneratorStats();
+		std::filesystem::create_directories(root);
+
+		std::vector<std::string> characters = MakeCharacters();
+		WriteFile(root / "_char.txt", RenderCharacters(characters));
+
+		size_t sequenceCount = std::max<size_t>(m_options.sequences, 1);
+
+		size_t fileNumber = 0;
+		for (size_t s = 0; s < sequenceCount; ++s)
+		{
+			std::string name = std::string(m_random.Pick(k_sequenceNames)) + "_" + std::to_string(s + 1);
+			std::filesystem::path seqPath = root / (PadNumber(s, 2) + "_" + name);
+			std::filesystem::create_directories(seqPath);
+
+			size_t sceneCount = m_options.scenes / sequenceCount + ((s < m_options.scenes % sequenceCount) ? 1 : 0);
+			for (size_t i = 0; i < sceneCount; ++i, ++fileNumber)
+			{
+				std::string slug = MakeSlug();
+				std::string fileName = (m_options.messy)
+					? PadNumber(i, 3) + "a_scene.txt"
+					: PadNumber(fileNumber, 3) + "_" + NameFromSlug(slug) + ".txt";
+
+				WriteFile(seqPath / fileName, RenderScene(slug, characters));
+			}
+		}
+
+		return m_stats;
+	}
+
+private:
+	std::vector<std::string> MakeCharacters()
+	{
+		std::vector<std::string> result;
+		for (size_t i = 0; i < m_options.characters; ++i)
+		{
+			std::string name = k_characterNames[i % (sizeof(k_characterNames) / sizeof(k_characterNames[0]))];
+			if (i >= sizeof(k_characterNames) / sizeof(k_characterNames[0]))
+				name += " " + std::to_string(i / (sizeof(k_characterNames) / sizeof(k_characterNames[0])) + 1);
+			result.push_back(name);
+		}
+		return result;
+	}
+
+	std::string RenderCharacters(const std::vector<std::string>& characters)
+	{
+		std::string result;
+		for (const std::string& name : characters)
+		{
+			result.append(1, '[').append(name).append("]{ ")
+				.append(std::to_string(m_random.Range(40, 255))).append(", ")
+				.append(std::to_string(m_random.Range(40, 255))).append(", ")
+				.append(std::to_string(m_random.Range(40, 255))).append(", 255 }\n");
+			result.append("Generated character.\n\n");
+		}
+		return result;
+	}
+
+	std::string MakeSlug()
+	{
+		std::string slug = (m_random.Chance(0.5f)) ? "INT. " : "EXT. ";
+		slug.append(m_random.Pick(k_locations));
+		if (m_random.Chance(0.3f))
+			slug.append(" ").append(m_random.Pick(k_locations));
+		slug.append(" - ").append(m_random.Pick(k_times));
+		return slug;
+	}
+
+	std::string MakeLine()
+	{
+		size_t low = (m_options.wordsMean > m_options.wordsSpread) ? m_options.wordsMean - m_options.wordsSpread : 1;
+		size_t high = m_options.wordsMean + m_options.wordsSpread;
+		size_t count = (m_random.Range(low, high) + m_random.Range(low, high)) / 2;
+
+		std::string line;
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (i > 0)
+				line.append(1, ' ');
+			line.append(m_random.Pick(k_words));
+		}
+		line[0] = (char)(line[0] - 32);
+		line.append(1, '.');
+		return line;
+	}
+
+	// Matches Project::RenderScene unless the messy option is set
+	std::string RenderScene(const std::string& slug, const std::vector<std::string>& characters)
+	{
+		std::string file;
+		if (m_options.messy)
+		{
+			std::string lower = slug;
+			std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) { return (c >= 'A' && c <= 'Z') ? (char)(c + 32) : c; });
+			file.append("#").append(lower).append("\n");
+		}
+		else
+		{
+			file.append("# ").append(slug).append("\n\n");
+		}
+
+		// The first block after the slug has to be an action
+		file.append((m_options.messy) ? "*" : "* ").append(MakeLine()).append((m_options.messy) ? "\n" : "\n\n");
+		++m_stats.blocks;
+
+		std::string lastCharacter = "";
+		size_t blockCount = m_random.Range(m_options.blocksPerScene / 2, m_options.blocksPerScene + m_options.blocksPerScene / 2);
+		for (size_t i = 0; i < blockCount; ++i)
+		{
+			++m_stats.blocks;
+			if (m_random.Chance(m_options.noteRatio))
+			{
+				file.append("// ").append(MakeLine()).append((m_options.messy) ? "\n" : "\n\n");
+				continue;
+			}
+
+			if (characters.empty() || !m_random.Chance(m_options.dialogueRatio))
+			{
+				file.append((m_options.messy) ? "*" : "* ").append(MakeLine()).append((m_options.messy) ? "\n" : "\n\n");
+				continue;
+			}
+
+			const std::string& character = characters[m_random.Range(0, characters.size() - 1)];
+			if (character != lastCharacter)
+			{
+				if (m_options.messy)
+				{
+					std::string lower = character;
+					std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) { return (c >= 'A' && c <= 'Z') ? (char)(c + 32) : c; });
+					file.append("[ ").append(lower).append(" ]\n");
+				}
+				else
+				{
+					file.append(1, '[').append(character).append("]\n");
+				}
+				lastCharacter = character;
+			}
+
+			if (m_random.Chance(m_options.parentheticalRatio))
+			{
+				++m_stats.blocks;
+				file.append(1, '(').append(m_random.Pick(k_parentheticals)).append((m_options.messy) ? ")\n" : ")\n\n");
+			}
+			file.append(MakeLine()).append((m_options.messy) ? "\n" : "\n\n");
+		}
+		return file;
+	}
+
+	void WriteFile(const std::filesystem::path& path, const std::string& contents)
+	{
+		std::ofstream file(path, std::ios::binary);
+		file.write(contents.data(), (std::streamsize)contents.size());
+		++m_stats.files;
+		m_stats.bytes += contents.size();
+	}
+
+	std::string PadNumber(size_t val, size_t digits)
+	{
+		std::string result = std::to_string(val);
+		if (result.length() < digits)
+			result.insert(0, digits - result.length(), '0');
+
+		return result;
+	}
+
+	// Same as Project::NameFromSlug
+	std::string NameFromSlug(const std::string& line)
+	{
+		std::string result;
+		bool lastWasSpecial = false;
+		for (const char& c : line)
+		{
+			if (c >= 'A' && c <= 'Z')
+			{
+				lastWasSpecial = false;
+				result.push_back(c);
+				continue;
+			}
+			if (c >= 'a' && c <= 'z')
+			{
+				lastWasSpecial = false;
+				result.push_back((char)(c - 32));
+				continue;
+			}
+
+			if (lastWasSpecial)
+				continue;
+
+			lastWasSpecial = true;
+			result.push_back('_');
+		}
+		return result;
+	}
+
+	static constexpr const char* k_sequenceNames[] = { "Prologue", "Arrival", "Discovery", "Chase", "Fallout", "Reunion", "Storm", "Finale" };
+	static constexpr const char* k_characterNames[] = { "PHIL", "SIMON", "ANNA", "THE DRIVER", "MARGARET", "DETECTIVE RUIZ", "KAI", "OLD MAN",
+		"NORA", "JULES", "DOCTOR PATEL", "BEA", "TOMAS", "WAITRESS", "ELLIOT", "GRACE" };
+	static constexpr const char* k_locations[] = { "HOUSE", "KITCHEN", "CAR", "ROOFTOP", "STATION", "FOREST", "DINER", "OFFICE", "ALLEY", "BEACH" };
+	static constexpr const char* k_times[] = { "DAY", "NIGHT", "DUSK", "DAWN", "CONTINUOUS", "LATER" };
+	static constexpr const char* k_parentheticals[] = { "quietly", "beat", "to Phil", "laughing", "under her breath", "O.S." };
+	static constexpr const char* k_words[] = { "the", "a", "door", "light", "walks", "slowly", "across", "room", "and", "looks",
+		"back", "at", "window", "rain", "she", "he", "they", "never", "again", "what", "did", "you", "see", "there",
+		"nothing", "moves", "quiet", "car", "keys", "table", "phone", "rings", "waits", "for", "answer", "cold",
+		"coffee", "street", "empty", "turns", "around", "smiles", "but", "not", "yet", "we", "have", "to", "go", "now" };
+
+	GeneratorOptions m_options;
+	Random m_random;
+	GeneratorStats m_stats;
+};
@@ -0,0 +1 @@
+premake5 vs2022
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+
+#include "AsciiTransform.h"
+#include "BenchHarness.h"
+#include "LayoutBuilder.h"
+#include "LineScanner.h"
+#include "Project.h"
+#include "ProjectGenerator.h"
+#include "WordWrap.h"
+
+// Fixed glyph extents so the layout numbers do not depend on a font file
+static LineMetrics MakeMetrics()
+{
+	LineMetrics metrics;
+	metrics.fontSize = 20;
+	for (const char c : std::string("gjpqy,;"))
+	{
+		metrics.glyphBottom[(unsigned char)c] = 4.f;
+	}
+	return metrics;
+}
+
+static void WrapAll(Project& proj, TextBlock::Type type, std::vector<std::string>(LayoutBuilder::* lineBreaks)(const std::string&) const)
+{
+	LayoutBuilder builder;
+	size_t lines = 0;
+	for (size_t i = 0; i < proj.GetNumberOfSequences(); ++i)
+	{
+		for (const TextBlock& block : proj.GetSequence(i).blocks)
+		{
+			if (block.type == type)
+				lines += (builder.*lineBreaks)(block.content).size();
+		}
+	}
+
+	// Keeps the calls from being optimized away
+	if (lines == 0)
+		std::cerr << "bench -- no blocks to wrap" << std::endl;
+}
+
+// WordWrap against the word by word reference on random lines with the shapes that trip wrapping up:
+// runs of spaces, leading and trailing spaces, words longer than the limit and words ending right on it
+static bool CheckWordWrap(size_t limit)
+{
+	std::mt19937 rng(limit);
+	for (size_t i = 0; i < 20000; ++i)
+	{
+		std::string line;
+		size_t words = rng() % 40;
+		for (size_t w = 0; w < words; ++w)
+		{
+			line.append(rng() % 4 == 0 ? rng() % 3 : 1, ' ');
+			line.append(rng() % 16 == 0 ? limit - 1 + rng() % 3 : 1 + rng() % 10, (char)('a' + w % 26));
+		}
+		if (rng() % 4 == 0)
+			line.append(1 + rng() % 2, ' ');
+
+		std::vector<std::string> lines = WordWrap::LineBreaks(line, limit);
+		if (lines != WordWrap::LineBreaksReference(line, limit))
+		{
+			std::cerr << "bench -- WordWrap (" << WordWrap::GetInstructionSet() << ") wraps \"" << line << "\" differently at " << limit << " columns" << std::endl;
+			return false;
+		}
+
+		// Only a single word may run past the limit
+		for (const std::string& wrapped : lines)
+		{
+			if (wrapped.length() > limit && wrapped.find(' ') != std::string::npos)
+			{
+				std::cerr << "bench -- \"" << wrapped << "\" is longer than " << limit << " columns" << std::endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Every scene file of the project back to back
+static std::string ReadScenes(const std::filesystem::path& root)
+{
+	std::string buffer;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(root))
+	{
+		if (!entry.is_regular_file() || entry.path().extension() != ".txt")
+			continue;
+
+		std::ifstream file(entry.path(), std::ios::binary);
+		buffer.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+	return buffer;
+}
+
+// What LoadScene did before LineScanner, kept to compare against
+static size_t GetlineScan(const std::string& buffer)
+{
+	std::istringstream stream(buffer);
+	size_t count = 0;
+	std::string line;
+	while (std::getline(stream, line))
+	{
+		std::unordered_set<char> whitespace = { '\n', '\t', '\r', ' ' };
+		while (!line.empty() && whitespace.find(line.front()) != whitespace.end())
+			line.erase(0, 1);
+		while (!line.empty() && whitespace.find(line.back()) != whitespace.end())
+			line.pop_back();
+
+		count += (line.empty()) ? 0 : 1;
+	}
+	return count;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchOptions options;
+	if (!options.Parse(argc, argv))
+	{
+		std::cerr << "usage: bench [--repeat=N] [--sizes=small,medium,huge] [--out=path]" << std::endl;
+		return 2;
+	}
+
+	for (size_t limit : { 31, 36, 57 })
+	{
+		if (!CheckWordWrap(limit))
+			return 1;
+	}
+
+	BenchHarness harness("ss-view", options.repeat);
+	auto silent = [](const std::string&) {};
+
+	for (const std::string& size : options.sizes)
+	{
+		GeneratorOptions genOptions;
+		if (!genOptions.SetPreset(size))
+		{
+			std::cerr << "bench -- unknown size " << size << std::endl;
+			return 2;
+		}
+
+		std::filesystem::path root = std::filesystem::temp_directory_path() / ("ss-view-bench-" + size);
+		std::filesystem::remove_all(root);
+		ProjectGenerator(genOptions).Generate(root);
+
+		std::unique_ptr<Project> loading;
+		harness.Run("Project::Load", size,
+			[&]() { loading = std::make_unique<Project>(); loading->MsgCallback(silent); },
+			[&]() { loading->Load(root); });
+
+		harness.Run("Project::~Project", size,
+			[&]() { loading = std::make_unique<Project>(); loading->MsgCallback(silent); loading->Load(root); },
+			[&]() { loading.reset(); });
+
+		std::string scenes = ReadScenes(root);
+		LineScanner scanner;
+		LineScanner reference;
+		if (scanner.Scan(scenes).size() != reference.ScanScalar(scenes).size()
+			|| !std::equal(scanner.GetLines().begin(), scanner.GetLines().end(), reference.GetLines().begin(), [](const ScannedLine& a, const ScannedLine& b)
+				{
+					return a.begin == b.begin && a.end == b.end && a.kind == b.kind;
+				}))
+		{
+			std::cerr << "bench -- LineScanner::Scan (" << LineScanner::GetInstructionSet() << ") disagrees with ScanScalar" << std::endl;
+			return 1;
+		}
+
+		harness.Run("LineScanner::Scan", size, nullptr, [&]() { scanner.Scan(scenes); });
+		harness.SetBytesProcessed(scenes.size());
+		harness.Run("LineScanner::ScanScalar", size, nullptr, [&]() { scanner.ScanScalar(scenes); });
+		harness.SetBytesProcessed(scenes.size());
+		harness.Run("std::getline + Trim", size, nullptr, [&]()
+		{
+			if (GetlineScan(scenes) != reference.GetLines().size())
+				std::cerr << "bench -- getline found a different number of lines" << std::endl;
+		});
+		harness.SetBytesProcessed(scenes.size());
+
+		Project proj;
+		proj.MsgCallback(silent);
+		proj.Load(root);
+
+		LayoutBuilder wrapper;
+		for (size_t i = 0; i < proj.GetNumberOfSequences(); ++i)
+		{
+			for (const TextBlock& block : proj.GetSequence(i).blocks)
+			{
+				if (wrapper.DialogueLineBreaks(block.content) != WordWrap::LineBreaksReference(block.content, 36)
+					|| wrapper.ParentheticalLineBreaks(block.content) != WordWrap::LineBreaksReference(block.content, 31)
+					|| wrapper.ActionLineBreaks(block.content) != WordWrap::LineBreaksReference(block.content, 57))
+				{
+					std::cerr << "bench -- LayoutBuilder wraps \"" << block.content << "\" differently from the reference" << std::endl;
+					return 1;
+				}
+			}
+		}
+
+		harness.Run("LayoutBuilder::DialogueLineBreaks", size, nullptr,
+			[&]() { WrapAll(proj, TextBlock::Type::Dialogue, &LayoutBuilder::DialogueLineBreaks); });
+		harness.Run("LayoutBuilder::ParentheticalLineBreaks", size, nullptr,
+			[&]() { WrapAll(proj, TextBlock::Type::Parenthetical, &LayoutBuilder::ParentheticalLineBreaks); });
+		harness.Run("LayoutBuilder::ActionLineBreaks", size, nullptr,
+			[&]() { WrapAll(proj, TextBlock::Type::Action, &LayoutBuilder::ActionLineBreaks); });
+		harness.Run("WordWrap::LineBreaksReference", size, nullptr, [&]()
+		{
+			for (size_t i = 0; i < proj.GetNumberOfSequences(); ++i)
+			{
+				for (const TextBlock& block : proj.GetSequence(i).blocks)
+				{
+					if (block.type == TextBlock::Type::Action && WordWrap::LineBreaksReference(block.content, 57).empty())
+						std::cerr << "bench -- no lines for an action block" << std::endl;
+				}
+			}
+		});
+
+		// Every block once, cased and named the way Save and the character lookup do it
+		std::vector<std::string> texts;
+		size_t textBytes = 0;
+		for (size_t i = 0; i < proj.GetNumberOfSequences(); ++i)
+		{
+			for (const TextBlock& block : proj.GetSequence(i).blocks)
+			{
+				texts.emplace_back(block.content);
+				textBytes += block.content.size();
+			}
+		}
+
+		std::vector<std::string> upper = texts;
+		std::vector<char> name(texts.empty() ? 0 : std::max_element(texts.begin(), texts.end(), [](const std::string& a, const std::string& b) { return a.size() < b.size(); })->size());
+		for (const std::string& text : texts)
+		{
+			std::string folded = text;
+			std::string reference = text;
+			AsciiTransform::ToUpper(folded.data(), folded.size());
+			AsciiTransform::ToUpperScalar(reference.data(), reference.size());
+
+			std::string foldedName(text.size(), '\0');
+			std::string referenceName(text.size(), '\0');
+			foldedName.resize(AsciiTransform::NameFromSlug(text.data(), text.size(), foldedName.data()));
+			referenceName.resize(AsciiTransform::NameFromSlugScalar(text.data(), text.size(), referenceName.data()));
+			if (folded != reference || foldedName != referenceName)
+			{
+				std::cerr << "bench -- AsciiTransform disagrees with its scalar version on \"" << text << "\"" << std::endl;
+				return 1;
+			}
+		}
+
+		harness.Run("AsciiTransform::ToUpper", size, [&]() { upper = texts; },
+			[&]() { for (std::string& text : upper) AsciiTransform::ToUpper(text.data(), text.size()); });
+		harness.SetBytesProcessed(textBytes);
+		harness.Run("AsciiTransform::ToUpperScalar", size, [&]() { upper = texts; },
+			[&]() { for (std::string& text : upper) AsciiTransform::ToUpperScalar(text.data(), text.size()); });
+		harness.SetBytesProcessed(textBytes);
+		harness.Run("AsciiTransform::NameFromSlug", size, nullptr,
+			[&]() { for (const std::string& text : texts) AsciiTransform::NameFromSlug(text.data(), text.size(), name.data()); });
+		harness.SetBytesProcessed(textBytes);
+		harness.Run("AsciiTransform::NameFromSlugScalar", size, nullptr,
+			[&]() { for (const std::string& text : texts) AsciiTransform::NameFromSlugScalar(text.data(), text.size(), name.data()); });
+		harness.SetBytesProcessed(textBytes);
+
+		LineMetrics metrics = MakeMetrics();
+		LayoutBuilder builder;
+		harness.Run("LayoutBuilder::Build", size, nullptr, [&]()
+		{
+			for (size_t i = 0; i < proj.GetNumberOfSequences(); ++i)
+			{
+				Layout layout = builder.Build(proj.GetSequence(i), proj.Characters(), metrics);
+			}
+		});
+
+		std::filesystem::remove_all(root);
+	}
+
+	if (options.out.empty())
+	{
+		harness.WriteJson(std::cout);
+		return 0;
+	}
+
+	std::ofstream file(options.out);
+	if (!file)
+	{
+		std::cerr << "bench -- could not write " << options.out << std::endl;
+		return 1;
+	}
+	harness.WriteJson(file);
+	return 0;
+}
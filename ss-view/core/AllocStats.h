@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+enum class AllocPhase : uint8_t
+{
+	Other,
+	Load,
+	Wrap,
+	Layout,
+	Export,
+	Count
+};
+
+// Allocations per pipeline phase. Only counts when built with SS_ALLOC_STATS, which compiles in the
+// operator new override in AllocStats.cpp. The phase is per thread, ParallelFor hands it on to its workers.
+class AllocStats final
+{
+	struct Counters
+	{
+		std::atomic<size_t> allocations{ 0 };
+		std::atomic<size_t> bytes{ 0 };
+		std::atomic<size_t> peakLiveBytes{ 0 };
+	};
+
+	constexpr AllocStats() {}
+
+public:
+	static AllocStats& Get() { static AllocStats instance; return instance; }
+
+	AllocStats(const AllocStats& other) = delete;
+	AllocStats operator=(const AllocStats& other) = delete;
+
+	static constexpr bool IsCompiledIn()
+	{
+#ifdef SS_ALLOC_STATS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	AllocPhase GetPhase() const { return s_phase; }
+	void SetPhase(AllocPhase phase) { s_phase = phase; }
+
+	void OnAllocate(size_t size) noexcept
+	{
+		Counters& counters = m_counters[(size_t)GetPhase()];
+		counters.allocations.fetch_add(1, std::memory_order_relaxed);
+		counters.bytes.fetch_add(size, std::memory_order_relaxed);
+
+		size_t live = m_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+		size_t peak = counters.peakLiveBytes.load(std::memory_order_relaxed);
+		while (live > peak && !counters.peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+	}
+
+	void OnFree(size_t size) noexcept { m_liveBytes.fetch_sub(size, std::memory_order_relaxed); }
+
+	void Print(std::ostream& out) const
+	{
+		static const char* names[] = { "other", "load", "wrap", "layout", "export" };
+
+		out << "Allocations per phase (peak live bytes count everything alive while the phase ran)\n";
+		for (size_t i = 0; i < (size_t)AllocPhase::Count; ++i)
+		{
+			const Counters& counters = m_counters[i];
+			if (counters.allocations.load() == 0)
+				continue;
+
+			out << "  " << names[i] << ": " << counters.allocations.load() << " allocations, "
+				<< counters.bytes.load() << " bytes, " << counters.peakLiveBytes.load() << " peak live bytes\n";
+		}
+		out.flush();
+	}
+
+private:
+	static inline thread_local AllocPhase s_phase = AllocPhase::Other;
+
+	std::atomic<size_t> m_liveBytes{ 0 };
+	Counters m_counters[(size_t)AllocPhase::Count];
+};
+
+// Restores the previous phase on exit so a wrap inside a layout is counted as wrap, then back to layout
+class AllocPhaseScope
+{
+public:
+	AllocPhaseScope(AllocPhase phase) : m_previous(AllocStats::Get().GetPhase()) { AllocStats::Get().SetPhase(phase); }
+	~AllocPhaseScope() { AllocStats::Get().SetPhase(m_previous); }
+
+	AllocPhaseScope(const AllocPhaseScope& other) = delete;
+	AllocPhaseScope operator=(const AllocPhaseScope& other) = delete;
+
+private:
+	AllocPhase m_previous;
+};
+
+#define ALLOC_PHASE_CONCAT_INNER(a, b) a##b
+#define ALLOC_PHASE_CONCAT(a, b) ALLOC_PHASE_CONCAT_INNER(a, b)
+#define ALLOC_PHASE(phase) AllocPhaseScope ALLOC_PHASE_CONCAT(allocPhase, __LINE__)(phase)
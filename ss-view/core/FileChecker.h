@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Profiler.h"
+
 #include <filesystem>
 #include <chrono>
 #include <unordered_map>
@@ -16,6 +18,7 @@ public:
 	// false -> no change
 	bool CheckFiles()
 	{
+		PROFILE_SCOPE("FileChecker::CheckFiles");
 		bool result = false;
 		m_fileDataNew->clear();
 
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+// Loads each font file once and keeps track of which character sizes have their glyphs rendered
+class FontManager final
+{
+	struct Entry
+	{
+		std::unique_ptr<sf::Font> font;
+		std::set<uint32_t> warmSizes;
+	};
+
+	FontManager() {}
+
+public:
+	static FontManager& Get() { static FontManager instance; return instance; }
+
+	FontManager(const FontManager& other) = delete;
+	FontManager operator=(const FontManager& other) = delete;
+
+	const sf::Font& GetFont(const std::string& path)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return *GetEntry(path).font;
+	}
+
+	// Renders every single byte glyph for the size so the first draw at that size does not stall
+	void Prewarm(const std::string& path, uint32_t size)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Entry& entry = GetEntry(path);
+		if (!entry.warmSizes.insert(size).second)
+			return;
+
+		for (size_t c = 0; c < 256; ++c)
+		{
+			sf::String str(std::string(1, (char)c));
+			if (str.isEmpty())
+				continue;
+
+			entry.font->getGlyph(str[0], size, false);
+		}
+	}
+
+	// Bytes used by the glyph pages of all warmed sizes (RGBA)
+	size_t GetAtlasMemory()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		size_t total = 0;
+		for (const auto& pair : m_fonts)
+		{
+			for (uint32_t size : pair.second.warmSizes)
+			{
+				sf::Vector2u textureSize = pair.second.font->getTexture(size).getSize();
+				total += (size_t)textureSize.x * textureSize.y * 4;
+			}
+		}
+		return total;
+	}
+
+private:
+	Entry& GetEntry(const std::string& path)
+	{
+		Entry& entry = m_fonts[path];
+		if (entry.font == nullptr)
+		{
+			entry.font = std::make_unique<sf::Font>();
+			if (!entry.font->loadFromFile(path))
+				std::cout << "FontManager -- Could not load " << path << std::endl;
+		}
+		return entry;
+	}
+
+	std::map<std::string, Entry> m_fonts;
+	std::mutex m_mutex;
+};
@@ -1,360 +1,407 @@
 #include "Formatter.h"
 
+#include "AllocStats.h"
+#include "Profiler.h"
 #include "Settings.h"
 
 #include <algorithm>
 
-static std::string Tab(uint8_t num)
-{
-	std::string result;
-	for (uint8_t i = 0; i < num; ++i)
-	{
-		result.append("    ");
-	}
-	return result;
-}
-
 Formatter::Formatter()
 {
-	m_fontReg.loadFromFile(Settings::Get().fontPath);
+	m_fontReg = &FontManager::Get().GetFont(Settings::Get().fontPath);
+	SetFontSize(m_fontSize);
 }
 
-void Formatter::LoadFromSequence(const Sequence& seq, const CharacterCollection& chars, bool darkMode, bool skipOffsetReset)
+Formatter::~Formatter()
 {
-	m_slugRegions.clear();
-	m_blocks.clear();
-	if (!skipOffsetReset)
+	for (std::future<void>& prefetch : m_prefetches)
 	{
-		m_scrollOffset = 0.f;
+		prefetch.wait();
 	}
+}
 
-	std::string lastCharacter = "";
-	bool wasLastBlockDialogue = false;
-
-	Paragraph paragraph;
-
-	for (const TextBlock& block : seq.blocks)
-	{
-		if (block.type == TextBlock::Type::Note)
-			continue;
+void Formatter::LoadFromSequence(const Sequence& seq, const CharacterCollection& chars, bool darkMode, bool skipOffsetReset)
+{
+	PROFILE_SCOPE("Formatter::LoadFromSequence");
+	ApplyLayout(std::make_shared<const Layout>(m_builder.Build(seq, chars, m_metrics)), chars, darkMode, skipOffsetReset);
+}
 
-		paragraph = AppendParagraph();
+void Formatter::LoadFromProject(Project& proj, size_t sequenceIndex, bool darkMode, bool skipOffsetReset)
+{
+	PROFILE_SCOPE("Formatter::LoadFromProject");
+	ApplyLayout(GetLayout(proj, sequenceIndex), proj.Characters(), darkMode, skipOffsetReset);
+	PrefetchNeighbours(proj, sequenceIndex);
+}
 
-		if (block.type == TextBlock::Type::Parenthetical ||
-			block.type == TextBlock::Type::Dialogue)
+void Formatter::LoadContinuous(Project& proj, size_t sequenceIndex, bool darkMode, float windowHeight)
+{
+	PROFILE_SCOPE("Formatter::LoadContinuous");
+	m_isContinuous = true;
+	m_project = &proj;
+	m_darkMode = darkMode;
+	m_windowHeight = windowHeight;
+	SetCharacterColors(proj.Characters());
+
+	// Only the height and slug regions of each sequence are kept, the layouts themselves stay in the bounded cache
+	size_t count = proj.GetNumberOfSequences();
+	std::vector<float> heights(count);
+	std::vector<std::vector<SlugRegion>> regions(count);
+	LineMetrics metrics = m_metrics;
+	ParallelFor(count, 0, [&](size_t i)
 		{
-			if (!wasLastBlockDialogue || block.character != lastCharacter)
-			{
-				//Empty Line
-				paragraph.AppendRun(" ");
-				paragraph.SetFont(m_fontReg);
-				paragraph.SetFontSize(m_fontSize);
-
-				paragraph = AppendParagraph();
-
-				if (block.character == lastCharacter)
-					paragraph.AppendRun(Tab(k_characterTabs) + block.character + " (CONT'D)");
-				else
-					paragraph.AppendRun(Tab(k_characterTabs) + block.character);
-
-				if (chars.Contains(block.character))
-				{
-					paragraph.SetColor(chars[block.character].color);
-				}
-				paragraph.SetFont(m_fontReg);
-				paragraph.SetFontSize(m_fontSize);
-				paragraph = AppendParagraph();
-			}
-
-			if (block.type == TextBlock::Type::Parenthetical)
-			{
-				std::vector<std::string> formatted = ParentheticalLineBreaks(block.content);
-				for (size_t i = 0; i < formatted.size(); ++i)
-				{
-					if (i > 0)
-					{
-						formatted[i] = " " + formatted[i];
-					}
-					else if (i == 0)
-					{
-						formatted[i] = "(" + formatted[i];
-					}
-					if (i == formatted.size() - 1)
-					{
-						formatted[i].push_back(')');
-					}
-					paragraph.AppendRun(Tab(k_parenthTabs) + formatted[i]);
-					paragraph.SetFont(m_fontReg);
-					paragraph.SetFontSize(m_fontSize);
-					if (i != formatted.size() - 1 )
-					{
-						paragraph = AppendParagraph();
-					}
-				}
-			}
-			else // Dialogue
-			{
-				std::vector<std::string> formatted = DialogueLineBreaks(block.content);
-				for (const std::string& line : formatted)
-				{
-					paragraph.AppendRun(Tab(k_dialogueTabs) + line);
-					paragraph.SetFont(m_fontReg);
-					paragraph.SetFontSize(m_fontSize);
-					if (line != formatted.back())
-					{
-						paragraph = AppendParagraph();
-					}
-				}
-			}
+			std::shared_ptr<const Layout> layout = m_cache.Find({ i, metrics.fontSize });
+			if (layout == nullptr)
+				layout = std::make_shared<const Layout>(m_builder.Build(proj.GetSequence(i), proj.Characters(), metrics));
 
-			lastCharacter = block.character;
-			wasLastBlockDialogue = true;
-			continue;
-		}
+			heights[i] = layout->height;
+			regions[i] = layout->slugRegions;
+		});
 
-		wasLastBlockDialogue = false;
-
-		//Empty Line
-		paragraph.AppendRun(" ");
-		paragraph.SetFont(m_fontReg);
-		paragraph.SetFontSize(m_fontSize);
-
-		paragraph = AppendParagraph();
-
-		if (block.type == TextBlock::Type::Slug)
-		{
-			m_slugRegions.push_back(SlugRegion(m_blocks.size() - 1, block.slugCount));
-			paragraph.AppendRun(SlugFormat(block.slugCount, block.content));
-			paragraph.SetFont(m_fontReg);
-			paragraph.SetBold(darkMode);
-			paragraph.SetFontSize(m_fontSize);
-			continue;
-		}
-
-		//Action
-		std::vector<std::string> formatted = ActionLineBreaks(block.content);
-		for (const std::string& line : formatted)
-		{
-			paragraph.AppendRun(Tab(k_actionTabs) + line);
-			paragraph.SetFont(m_fontReg);
-			paragraph.SetFontSize(m_fontSize);
-			if (line != formatted.back())
-			{
-				paragraph = AppendParagraph();
-			}
-		}
-	}
-
-	float cursor = 0.f;
-	size_t slugIndex = 0;
-	for (size_t i = 0; i < m_blocks.size(); ++i)
+	m_chunks.clear();
+	m_chunks.resize(count);
+	m_slugRegions.clear();
+	float top = 0.f;
+	for (size_t i = 0; i < count; ++i)
 	{
-		if (slugIndex < m_slugRegions.size() && i == m_slugRegions[slugIndex].objectIndex)
+		m_chunks[i].sequence = i;
+		m_chunks[i].top = top;
+		m_chunks[i].height = heights[i];
+		for (SlugRegion region : regions[i])
 		{
-			if (slugIndex != 0)
-			{
-				m_slugRegions[slugIndex - 1].bounds.y = cursor;
-			}
-			m_slugRegions[slugIndex++].bounds.x = cursor;
+			region.bounds += { top, top };
+			m_slugRegions.push_back(region);
 		}
-		sf::Text& block = m_blocks[i];
-		block.setFillColor((darkMode) ? sf::Color::White : sf::Color::Black);
-		block.setPosition({ k_xOffset, cursor - m_scrollOffset });
-		cursor += block.getLocalBounds().height + block.getLocalBounds().top;
+		top += heights[i];
 	}
+	m_scrollMax = top;
 
-	if (!m_slugRegions.empty())
+	m_documentSlugPositions.clear();
+	for (const SlugRegion& region : m_slugRegions)
 	{
-		m_slugRegions.back().bounds.y = cursor;
+		m_documentSlugPositions.push_back(region.bounds.x / m_scrollMax);
 	}
-	m_scrollMax = cursor;
+	m_slugScrollPositions = &m_documentSlugPositions;
+
+	ScrollToSequence(sequenceIndex, windowHeight);
 }
 
-void Formatter::DrawTo(sf::RenderWindow& window)
+void Formatter::ClearCache()
 {
-	for (sf::Text& block : m_blocks)
+	for (std::future<void>& prefetch : m_prefetches)
 	{
-		window.draw(block);
+		prefetch.wait();
 	}
+	m_prefetches.clear();
+	m_cache.Clear();
 }
 
-void Formatter::OnScroll(float delta, float windowHeight, float& out_t)
+void Formatter::SetDarkMode(bool darkMode)
 {
-	if (GetContentSize() <= windowHeight)
+	if (m_darkMode == darkMode)
 		return;
 
-	m_scrollOffset -= delta;
-	m_scrollOffset = std::max(m_scrollOffset, 0.f);
-	m_scrollOffset = std::min(m_scrollOffset, m_scrollMax - windowHeight + m_fontSize);
+	m_darkMode = darkMode;
+	ColorBlocks();
+}
+
+void Formatter::SetFontSize(uint32_t size)
+{
+	m_fontSize = size;
+	if (m_metrics.fontSize == size)
+		return;
 
-	float cursor = -m_scrollOffset;
-	for (sf::Text& block : m_blocks)
+	// Render the glyphs for the new size before any line is drawn with it
+	FontManager::Get().Prewarm(Settings::Get().fontPath, size);
+
+	m_metrics.fontSize = size;
+	for (size_t c = 0; c < m_metrics.glyphBottom.size(); ++c)
 	{
-		block.setPosition({ k_xOffset, cursor });
-		cursor += block.getLocalBounds().height + block.getLocalBounds().top;
-	}
+		// Go through sf::String so bytes above 127 map to the same code point sf::Text will use
+		sf::String str(std::string(1, (char)c));
+		if (str.isEmpty())
+			continue;
 
-	out_t = m_scrollOffset / (m_scrollMax - windowHeight + m_fontSize);
+		sf::FloatRect bounds = m_fontReg->getGlyph(str[0], size, false).bounds;
+		m_metrics.glyphBottom[c] = bounds.top + bounds.height;
+	}
 }
 
-void Formatter::SetScroll(float t, float windowHeight)
+std::shared_ptr<const Layout> Formatter::GetLayout(Project& proj, size_t sequenceIndex)
 {
-	m_scrollOffset = t * (m_scrollMax - windowHeight + m_fontSize);
-
-	float cursor = -m_scrollOffset;
-	for (sf::Text& block : m_blocks)
+	LayoutKey key{ sequenceIndex, m_fontSize };
+	std::shared_ptr<const Layout> layout = m_cache.Find(key);
+	if (layout == nullptr)
 	{
-		block.setPosition({ k_xOffset, cursor });
-		cursor += block.getLocalBounds().height + block.getLocalBounds().top;
+		layout = std::make_shared<const Layout>(m_builder.Build(proj.GetSequence(sequenceIndex), proj.Characters(), m_metrics));
+		m_cache.Insert(key, layout);
 	}
+	return layout;
 }
 
-void Formatter::TryOpenFile(const sf::Vector2f& point, const Project& proj)
+void Formatter::ApplyLayout(std::shared_ptr<const Layout> layout, const CharacterCollection& chars, bool darkMode, bool skipOffsetReset)
 {
-	for (const SlugRegion& region : m_slugRegions)
+	ALLOC_PHASE(AllocPhase::Layout);
+	m_isContinuous = false;
+	m_project = nullptr;
+	m_slugRegions = layout->slugRegions;
+	m_slugScrollPositions = &layout->slugScrollPositions;
+	m_scrollMax = layout->height;
+	m_darkMode = darkMode;
+	if (!skipOffsetReset)
 	{
-		if (point.y < region.bounds.x - m_scrollOffset || point.y >= region.bounds.y - m_scrollOffset)
-			continue;
+		m_scrollOffset = 0.f;
+	}
 
-		std::string path = proj.FileFromSlug(region.slugNumber).string();
-		if (path.find_first_of('\"') == std::string::npos)
-			path = "\"" + path + "\"";
+	SetCharacterColors(chars);
 
-		std::string cmd = "start notepad " + path;
-		system(cmd.c_str());
-	}
+	m_chunks.clear();
+	Chunk& chunk = m_chunks.emplace_back();
+	chunk.height = layout->height;
+	Materialize(chunk, layout);
+	PositionBlocks();
 }
 
-std::vector<float> Formatter::GetSlugScrollPositions() const
+void Formatter::SetCharacterColors(const CharacterCollection& chars)
 {
-	std::vector<float> result(m_slugRegions.size());
-	float invContentHeight = 1.f / m_scrollMax;
-
-	for (size_t i = 0; i < result.size(); ++i)
+	m_characterColors.clear();
+	for (const Character& character : chars.data)
 	{
-		float slugY = m_slugRegions[i].bounds.x;
-		result[i] = slugY * invContentHeight;
+		m_characterColors.push_back(character.color);
 	}
-
-	return result;
 }
 
-Formatter::Paragraph Formatter::AppendParagraph()
+void Formatter::Materialize(Chunk& chunk, std::shared_ptr<const Layout> layout)
 {
-	Paragraph p;
-	p.text = &m_blocks.emplace_back();
-	return p;
+	PROFILE_SCOPE("Formatter::Materialize");
+	ALLOC_PHASE(AllocPhase::Layout);
+	chunk.layout = layout;
+	chunk.blocks.clear();
+	chunk.blocks.resize(layout->lines.size());
+	for (size_t i = 0; i < chunk.blocks.size(); ++i)
+	{
+		const LayoutLine& line = layout->lines[i];
+		sf::Text& block = chunk.blocks[i];
+		block.setFont(*m_fontReg);
+		block.setCharacterSize(m_fontSize);
+		block.setString(line.text);
+		if (line.role != ColorRole::Text)
+		{
+			block.setOutlineThickness(0.5f);
+		}
+	}
+
+	ColorChunk(chunk);
 }
 
-std::vector<std::string> Formatter::DialogueLineBreaks(const std::string& line)
+void Formatter::UpdateMaterialized()
 {
-	std::stringstream stream(line);
-	std::vector<std::string> result;
+	if (!m_isContinuous || m_chunks.empty())
+		return;
+
+	// Keep one window of margin above and below so small scrolls never have to build geometry
+	float begin = m_scrollOffset - m_windowHeight;
+	float end = m_scrollOffset + m_windowHeight * 2.f;
 
-	int counter = 0;
-	std::string word;
-	std::string currLine;
+	auto first = std::upper_bound(m_chunks.begin(), m_chunks.end(), begin, [](float value, const Chunk& c)
+		{
+			return value < c.top;
+		});
+	size_t firstIndex = (first == m_chunks.begin()) ? 0 : (size_t)(first - m_chunks.begin()) - 1;
+	size_t lastIndex = firstIndex;
+	while (lastIndex + 1 < m_chunks.size() && m_chunks[lastIndex + 1].top < end)
+	{
+		++lastIndex;
+	}
 
-	while (std::getline(stream, word, ' '))
+	for (size_t i = 0; i < m_chunks.size(); ++i)
 	{
-		counter += word.length();
-		if (counter + 1 > k_dialogueLimit)
+		Chunk& chunk = m_chunks[i];
+		bool isNear = i >= firstIndex && i <= lastIndex;
+		if (isNear && chunk.layout == nullptr)
 		{
-			result.push_back(currLine);
-			counter = word.length();
-			currLine = word;
-			continue;
+			Materialize(chunk, GetLayout(*m_project, chunk.sequence));
 		}
-		if (!currLine.empty())
+		else if (!isNear && chunk.layout != nullptr)
 		{
-			currLine.push_back(' ');
-			++counter;
+			chunk.layout.reset();
+			chunk.blocks.clear();
+			chunk.blocks.shrink_to_fit();
 		}
-		currLine.append(word);
 	}
-	result.push_back(currLine);
 
-	return result;
+	PrefetchNeighbours(*m_project, firstIndex);
+	if (lastIndex != firstIndex)
+		PrefetchNeighbours(*m_project, lastIndex);
 }
 
-std::vector<std::string> Formatter::ParentheticalLineBreaks(const std::string& line)
+void Formatter::PrefetchNeighbours(Project& proj, size_t sequenceIndex)
 {
-	std::stringstream stream(line);
-	std::vector<std::string> result;
+	m_prefetches.erase(std::remove_if(m_prefetches.begin(), m_prefetches.end(), [](const std::future<void>& f)
+		{
+			return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}), m_prefetches.end());
 
-	int counter = 0;
-	std::string word;
-	std::string currLine;
+	std::vector<size_t> neighbours;
+	if (sequenceIndex > 0)
+		neighbours.push_back(sequenceIndex - 1);
+	if (sequenceIndex + 1 < proj.GetNumberOfSequences())
+		neighbours.push_back(sequenceIndex + 1);
 
+	neighbours.erase(std::remove_if(neighbours.begin(), neighbours.end(), [&](size_t i)
+		{
+			return m_cache.Contains({ i, m_fontSize });
+		}), neighbours.end());
 
-	while (std::getline(stream, word, ' '))
-	{
-		counter += word.length();
-		if (counter + 1 > k_parentheticalLimit)
+	if (neighbours.empty())
+		return;
+
+	// The metrics are copied so the worker never touches the font
+	LineMetrics metrics = m_metrics;
+	m_prefetches.push_back(std::async(std::launch::async, [this, &proj, neighbours, metrics]()
 		{
-			result.push_back(currLine);
-			counter = word.length();
-			currLine = word;
+			for (size_t i : neighbours)
+			{
+				LayoutKey key{ i, metrics.fontSize };
+				if (m_cache.Contains(key))
+					continue;
 
-			continue;
-		}
-		if (!currLine.empty())
+				m_cache.Insert(key, std::make_shared<const Layout>(m_builder.Build(proj.GetSequence(i), proj.Characters(), metrics)));
+			}
+		}));
+}
+
+void Formatter::PositionBlocks()
+{
+	for (Chunk& chunk : m_chunks)
+	{
+		for (size_t i = 0; i < chunk.blocks.size(); ++i)
 		{
-			currLine.push_back(' ');
-			++counter;
+			chunk.blocks[i].setPosition({ k_xOffset, chunk.top + chunk.layout->lines[i].y - m_scrollOffset });
 		}
-		currLine.append(word);
 	}
-	result.push_back(currLine);
-
-	return result;
 }
 
-std::vector<std::string> Formatter::ActionLineBreaks(const std::string& line)
+void Formatter::ColorBlocks()
 {
-	std::stringstream stream(line);
-	std::vector<std::string> result;
+	for (Chunk& chunk : m_chunks)
+	{
+		ColorChunk(chunk);
+	}
+}
 
-	int counter = 0;
-	std::string word;
-	std::string currLine;
+void Formatter::ColorChunk(Chunk& chunk)
+{
+	const Palette& palette = (m_darkMode) ? k_darkPalette : k_lightPalette;
+	for (size_t i = 0; i < chunk.blocks.size(); ++i)
+	{
+		const LayoutLine& line = chunk.layout->lines[i];
+		chunk.blocks[i].setFillColor(palette.text);
+		if (line.role == ColorRole::Slug)
+			chunk.blocks[i].setOutlineColor(palette.slug);
+		else if (line.role == ColorRole::Character)
+			chunk.blocks[i].setOutlineColor(m_characterColors[line.characterIndex]);
+	}
+}
 
-	while (std::getline(stream, word, ' '))
+void Formatter::DrawTo(sf::RenderWindow& window)
+{
+	PROFILE_SCOPE("Formatter::DrawTo");
+	float windowHeight = (float)window.getSize().y;
+	for (Chunk& chunk : m_chunks)
 	{
-		counter += word.length();
-		if (counter + 1 > k_actionLimit)
-		{
-			result.push_back(currLine);
-			counter = word.length();
-			currLine = word;
+		float chunkY = chunk.top - m_scrollOffset;
+		if (chunk.layout == nullptr || chunkY > windowHeight || chunkY + chunk.height + m_fontSize * 2.f < 0.f)
 			continue;
-		}
-		if (!currLine.empty())
+
+		for (size_t i = 0; i < chunk.blocks.size(); ++i)
 		{
-			currLine.push_back(' ');
-			++counter;
+			// Skip lines outside the window so their geometry is never built
+			float y = chunkY + chunk.layout->lines[i].y;
+			if (y > windowHeight)
+				break;
+			if (y + m_fontSize * 2.f < 0.f)
+				continue;
+
+			window.draw(chunk.blocks[i]);
 		}
-		currLine.append(word);
 	}
-	result.push_back(currLine);
+}
 
-	return result;
+void Formatter::OnScroll(float delta, float windowHeight, float& out_t)
+{
+	if (GetContentSize() <= windowHeight)
+		return;
+
+	m_scrollOffset -= delta;
+	m_scrollOffset = std::max(m_scrollOffset, 0.f);
+	m_scrollOffset = std::min(m_scrollOffset, m_scrollMax - windowHeight + m_fontSize);
+
+	m_windowHeight = windowHeight;
+	UpdateMaterialized();
+	PositionBlocks();
+
+	out_t = m_scrollOffset / (m_scrollMax - windowHeight + m_fontSize);
 }
 
-std::string Formatter::SlugFormat(const uint32_t number, const std::string& line)
+void Formatter::SetScroll(float t, float windowHeight)
 {
-	std::string numstr = std::to_string(number);
-	std::string result = numstr;
+	m_scrollOffset = t * (m_scrollMax - windowHeight + m_fontSize);
 
-	for (size_t i = numstr.length(); i < 4; ++i)
-		result.push_back(' ');
+	m_windowHeight = windowHeight;
+	UpdateMaterialized();
+	PositionBlocks();
+}
 
-	result.append(line);
-	for (int i = 0; i < k_actionLimit - line.length() - numstr.length(); ++i)
-	{
-		result.push_back(' ');
-	}
-	result.append(numstr);
+float Formatter::GetScrollFactor(float windowHeight) const
+{
+	float range = m_scrollMax - windowHeight + m_fontSize;
+	if (range <= 0.f)
+		return 0.f;
+
+	return std::min(m_scrollOffset / range, 1.f);
+}
+
+void Formatter::ScrollToSequence(size_t sequenceIndex, float windowHeight)
+{
+	if (sequenceIndex >= m_chunks.size())
+		return;
+
+	m_scrollOffset = std::min(m_chunks[sequenceIndex].top, m_scrollMax - windowHeight + m_fontSize);
+	m_scrollOffset = std::max(m_scrollOffset, 0.f);
+
+	m_windowHeight = windowHeight;
+	UpdateMaterialized();
+	PositionBlocks();
+}
+
+size_t Formatter::GetSequenceAtScroll() const
+{
+	auto chunk = std::upper_bound(m_chunks.begin(), m_chunks.end(), m_scrollOffset, [](float value, const Chunk& c)
+		{
+			return value < c.top;
+		});
+
+	if (chunk == m_chunks.begin())
+		return 0;
+
+	return (--chunk)->sequence;
+}
+
+void Formatter::TryOpenFile(const sf::Vector2f& point, const Project& proj, ProcessLauncher& launcher)
+{
+	// Regions are laid out top to bottom so they are already sorted by their start
+	float y = point.y + m_scrollOffset;
+	auto region = std::upper_bound(m_slugRegions.begin(), m_slugRegions.end(), y, [](float value, const SlugRegion& r)
+		{
+			return value < r.bounds.x;
+		});
+
+	if (region == m_slugRegions.begin())
+		return;
+
+	--region;
+	if (y >= region->bounds.y)
+		return;
 
-	return result;
+	launcher.Open(Settings::Get().editorCommand, proj.FileFromSlug(region->slugNumber).string());
 }
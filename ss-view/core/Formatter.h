@@ -1,101 +1,120 @@
 #pragma once
 
+#include "FontManager.h"
+#include "LayoutBuilder.h"
+#include "LruCache.h"
+#include "ParallelFor.h"
+#include "ProcessLauncher.h"
 #include "Project.h"
 
 #include <SFML/Graphics.hpp>
 
+#include <future>
+#include <memory>
 #include <vector>
 
 class Formatter
 {
-	struct Paragraph
+	struct LayoutKey
 	{
-		sf::Text* text;
+		size_t sequence = 0;
+		uint32_t fontSize = 0;
 
-		void SetFontSize(float size)
+		bool operator==(const LayoutKey& other) const
 		{
-			text->setCharacterSize(size);
-		}
-
-		void SetFont(sf::Font& font)
-		{
-			text->setFont(font);
-		}
-
-		void AppendRun(const std::string& str)
-		{
-			std::string contents = text->getString();
-			text->setString(contents + str);
-		}
-
-		void SetColor(const sf::Color& color)
-		{
-			text->setOutlineColor(color);
-			text->setOutlineThickness(0.5f);
-		}
-
-		void SetBold(bool darkMode)
-		{
-			text->setOutlineThickness(0.5f);
-			text->setOutlineColor((darkMode) ? sf::Color::White : sf::Color::Black);
+			return sequence == other.sequence && fontSize == other.fontSize;
 		}
 	};
 
-	struct SlugRegion
+	struct Palette
 	{
-		uint32_t slugNumber = 0;
-		uint32_t objectIndex = 0;
-		sf::Vector2f bounds{};
+		sf::Color text;
+		sf::Color slug;
+	};
 
-		SlugRegion(const uint32_t i, const uint32_t s) : objectIndex(i), slugNumber(s) {}
+	// One sequence placed in the document, only holds geometry while it is near the viewport
+	struct Chunk
+	{
+		size_t sequence = 0;
+		float top = 0.f;
+		float height = 0.f;
+		std::shared_ptr<const Layout> layout;
+		std::vector<sf::Text> blocks;
 	};
 
 public:
 	Formatter();
+	~Formatter();
 
 	void LoadFromSequence(const Sequence& proj, const CharacterCollection& chars, bool darkMode, bool skipOffsetReset = false);
+	// Uses cached layouts where possible and prefetches the neighbouring sequences
+	void LoadFromProject(Project& proj, size_t sequenceIndex, bool darkMode, bool skipOffsetReset = false);
+	// Lays out every sequence as one document starting at the given sequence, only nearby sequences are materialized
+	void LoadContinuous(Project& proj, size_t sequenceIndex, bool darkMode, float windowHeight);
+	bool IsContinuous() const { return m_isContinuous; }
+	// Must be called before the project is reloaded
+	void ClearCache();
+	// Recolors the current lines in place
+	void SetDarkMode(bool darkMode);
 	void DrawTo(sf::RenderWindow& window);
 
 	void OnScroll(float delta, float windowHeight, float& out_t);
 
 	void SetScroll(float t, float windowHeight);
+	float GetScrollFactor(float windowHeight) const;
+
+	void ScrollToSequence(size_t sequenceIndex, float windowHeight);
+	size_t GetSequenceAtScroll() const;
 
-	void TryOpenFile(const sf::Vector2f& point, const Project& proj);
+	void TryOpenFile(const sf::Vector2f& point, const Project& proj, ProcessLauncher& launcher);
 
 	float GetContentSize() const { return m_scrollMax + m_fontSize; }
 
-	const sf::Font& GetFont() { return m_fontReg; }
+	const sf::Font& GetFont() { return *m_fontReg; }
 
-	void SetFontSize(uint32_t size) { m_fontSize = size; }
+	void SetFontSize(uint32_t size);
 	uint32_t GetFontSize() const { return m_fontSize; }
 
-	std::vector<float> GetSlugScrollPositions() const;
+	// Valid until the next sequence is loaded
+	const std::vector<float>& GetSlugScrollPositions() const { return *m_slugScrollPositions; }
 
 private:
-	Paragraph AppendParagraph();
-
-	std::vector<std::string> DialogueLineBreaks(const std::string& line);
-	std::vector<std::string> ParentheticalLineBreaks(const std::string& line);
-	std::vector<std::string> ActionLineBreaks(const std::string& line);
-	std::string SlugFormat(const uint32_t number, const std::string& line);
+	std::shared_ptr<const Layout> GetLayout(Project& proj, size_t sequenceIndex);
+	void ApplyLayout(std::shared_ptr<const Layout> layout, const CharacterCollection& chars, bool darkMode, bool skipOffsetReset);
+	void SetCharacterColors(const CharacterCollection& chars);
+	void Materialize(Chunk& chunk, std::shared_ptr<const Layout> layout);
+	void UpdateMaterialized();
+	void PrefetchNeighbours(Project& proj, size_t sequenceIndex);
+	void PositionBlocks();
+	void ColorBlocks();
+	void ColorChunk(Chunk& chunk);
 
 private:
 
-	sf::Font m_fontReg;
+	const sf::Font* m_fontReg = nullptr;
+	LineMetrics m_metrics;
+	LayoutBuilder m_builder;
 
-	std::vector<sf::Text> m_blocks;
+	std::vector<Chunk> m_chunks;
 	std::vector<SlugRegion> m_slugRegions;
+	std::vector<float> m_documentSlugPositions;
+	const std::vector<float>* m_slugScrollPositions = nullptr;
+	std::vector<sf::Color> m_characterColors;
+	bool m_darkMode = true;
+
+	bool m_isContinuous = false;
+	Project* m_project = nullptr;
+	float m_windowHeight = 0.f;
+
+	LruCache<LayoutKey, Layout> m_cache;
+	std::vector<std::future<void>> m_prefetches;
 
 	float m_scrollOffset = 0.f;
 	float m_scrollMax = 0.f;
 	uint32_t m_fontSize = 20;
 
+	const Palette k_darkPalette{ sf::Color::White, sf::Color::White };
+	const Palette k_lightPalette{ sf::Color::Black, sf::Color::Black };
+
 	const float k_xOffset = 20.f;
-	const int k_dialogueLimit = 36;
-	const int k_parentheticalLimit = 31;
-	const int k_actionLimit = 57;
-	const int k_actionTabs = 1;
-	const int k_characterTabs = 5;
-	const int k_parenthTabs = 4;
-	const int k_dialogueTabs = 3;
 };
\ No newline at end of file
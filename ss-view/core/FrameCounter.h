@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <algorithm>
+
+// Counts rendered frames and publishes the total once a second
+class FrameCounter
+{
+public:
+	void OnFrame() { ++m_frames; }
+
+	// true -> a new frames per second value was published
+	bool Update()
+	{
+		if (m_clock.getElapsedTime().asSeconds() < 1.f)
+			return false;
+
+		m_framesPerSecond = m_frames;
+		m_frames = 0;
+		m_clock.restart();
+		return true;
+	}
+
+	uint32_t GetFramesPerSecond() const { return m_framesPerSecond; }
+
+	float GetTimeToNextUpdate() const
+	{
+		return std::max(1.f - m_clock.getElapsedTime().asSeconds(), 0.f);
+	}
+
+private:
+	sf::Clock m_clock;
+	uint32_t m_frames = 0;
+	uint32_t m_framesPerSecond = 0;
+};
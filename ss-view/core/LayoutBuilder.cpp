@@ -0,0 +1,217 @@
+#include "LayoutBuilder.h"
+
+#include "AllocStats.h"
+#include "Profiler.h"
+#include "WordWrap.h"
+
+#include <algorithm>
+
+static std::string Tab(uint8_t num)
+{
+	std::string result;
+	for (uint8_t i = 0; i < num; ++i)
+	{
+		result.append("    ");
+	}
+	return result;
+}
+
+float LineMetrics::LineHeight(const std::string& text, bool hasOutline) const
+{
+	if (text.empty())
+		return 0.f;
+
+	// Matches the bottom of sf::Text::getLocalBounds(), whitespace sits on the baseline
+	float bottom = 0.f;
+	for (const char c : text)
+	{
+		if (c == ' ' || c == '\t')
+			bottom = std::max(bottom, (float)fontSize);
+		else
+			bottom = std::max(bottom, fontSize + glyphBottom[(unsigned char)c]);
+	}
+
+	// sf::Text pads its bounds by the rounded up outline thickness
+	if (hasOutline)
+		bottom += 1.f;
+
+	return bottom;
+}
+
+Layout LayoutBuilder::Build(const Sequence& seq, const CharacterCollection& chars, const LineMetrics& metrics) const
+{
+	PROFILE_SCOPE("LayoutBuilder::Build");
+	ALLOC_PHASE(AllocPhase::Layout);
+	Layout layout;
+
+	std::string lastCharacter = "";
+	bool wasLastBlockDialogue = false;
+
+	auto newLine = [&]() { layout.lines.emplace_back(); return layout.lines.size() - 1; };
+
+	for (const TextBlock& block : seq.blocks)
+	{
+		if (block.type == TextBlock::Type::Note)
+			continue;
+
+		size_t line = newLine();
+
+		if (block.type == TextBlock::Type::Parenthetical ||
+			block.type == TextBlock::Type::Dialogue)
+		{
+			if (!wasLastBlockDialogue || block.character != lastCharacter)
+			{
+				//Empty Line
+				layout.lines[line].text.append(" ");
+
+				line = newLine();
+
+				if (block.character == lastCharacter)
+					layout.lines[line].text.append(Tab(k_characterTabs) + block.character + " (CONT'D)");
+				else
+					layout.lines[line].text.append(Tab(k_characterTabs) + block.character);
+
+				auto character = std::find_if(chars.data.begin(), chars.data.end(), [&](const Character& c) { return c.name == block.character; });
+				if (character != chars.data.end())
+				{
+					layout.lines[line].role = ColorRole::Character;
+					layout.lines[line].characterIndex = (uint32_t)(character - chars.data.begin());
+				}
+				line = newLine();
+			}
+
+			if (block.type == TextBlock::Type::Parenthetical)
+			{
+				std::vector<std::string> formatted = ParentheticalLineBreaks(block.content);
+				for (size_t i = 0; i < formatted.size(); ++i)
+				{
+					if (i > 0)
+					{
+						formatted[i] = " " + formatted[i];
+					}
+					else if (i == 0)
+					{
+						formatted[i] = "(" + formatted[i];
+					}
+					if (i == formatted.size() - 1)
+					{
+						formatted[i].push_back(')');
+					}
+					layout.lines[line].text.append(Tab(k_parenthTabs) + formatted[i]);
+					if (i != formatted.size() - 1 )
+					{
+						line = newLine();
+					}
+				}
+			}
+			else // Dialogue
+			{
+				std::vector<std::string> formatted = DialogueLineBreaks(block.content);
+				for (const std::string& str : formatted)
+				{
+					layout.lines[line].text.append(Tab(k_dialogueTabs) + str);
+					if (str != formatted.back())
+					{
+						line = newLine();
+					}
+				}
+			}
+
+			lastCharacter = block.character;
+			wasLastBlockDialogue = true;
+			continue;
+		}
+
+		wasLastBlockDialogue = false;
+
+		//Empty Line
+		layout.lines[line].text.append(" ");
+
+		line = newLine();
+
+		if (block.type == TextBlock::Type::Slug)
+		{
+			layout.slugRegions.push_back(SlugRegion((uint32_t)line, block.slugCount));
+			layout.lines[line].text.append(SlugFormat(block.slugCount, block.content));
+			layout.lines[line].role = ColorRole::Slug;
+			continue;
+		}
+
+		//Action
+		std::vector<std::string> formatted = ActionLineBreaks(block.content);
+		for (const std::string& str : formatted)
+		{
+			layout.lines[line].text.append(Tab(k_actionTabs) + str);
+			if (str != formatted.back())
+			{
+				line = newLine();
+			}
+		}
+	}
+
+	float cursor = 0.f;
+	size_t slugIndex = 0;
+	for (size_t i = 0; i < layout.lines.size(); ++i)
+	{
+		if (slugIndex < layout.slugRegions.size() && i == layout.slugRegions[slugIndex].objectIndex)
+		{
+			if (slugIndex != 0)
+			{
+				layout.slugRegions[slugIndex - 1].bounds.y = cursor;
+			}
+			layout.slugRegions[slugIndex++].bounds.x = cursor;
+		}
+		layout.lines[i].y = cursor;
+		cursor += metrics.LineHeight(layout.lines[i].text, layout.lines[i].role != ColorRole::Text);
+	}
+
+	if (!layout.slugRegions.empty())
+	{
+		layout.slugRegions.back().bounds.y = cursor;
+	}
+	layout.height = cursor;
+
+	layout.slugScrollPositions.reserve(layout.slugRegions.size());
+	for (const SlugRegion& region : layout.slugRegions)
+	{
+		layout.slugScrollPositions.push_back(region.bounds.x / layout.height);
+	}
+
+	return layout;
+}
+
+std::vector<std::string> LayoutBuilder::DialogueLineBreaks(const std::string& line) const
+{
+	ALLOC_PHASE(AllocPhase::Wrap);
+	return WordWrap::LineBreaks(line, k_dialogueLimit);
+}
+
+std::vector<std::string> LayoutBuilder::ParentheticalLineBreaks(const std::string& line) const
+{
+	ALLOC_PHASE(AllocPhase::Wrap);
+	return WordWrap::LineBreaks(line, k_parentheticalLimit);
+}
+
+std::vector<std::string> LayoutBuilder::ActionLineBreaks(const std::string& line) const
+{
+	ALLOC_PHASE(AllocPhase::Wrap);
+	return WordWrap::LineBreaks(line, k_actionLimit);
+}
+
+std::string LayoutBuilder::SlugFormat(const uint32_t number, const std::string& line) const
+{
+	std::string numstr = std::to_string(number);
+	std::string result = numstr;
+
+	for (size_t i = numstr.length(); i < 4; ++i)
+		result.push_back(' ');
+
+	result.append(line);
+	for (int i = 0; i < k_actionLimit - line.length() - numstr.length(); ++i)
+	{
+		result.push_back(' ');
+	}
+	result.append(numstr);
+
+	return result;
+}
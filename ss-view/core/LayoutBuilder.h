@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Project.h"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+struct SlugRegion
+{
+	uint32_t slugNumber = 0;
+	uint32_t objectIndex = 0;
+	sf::Vector2f bounds{};
+
+	SlugRegion(const uint32_t i, const uint32_t s) : objectIndex(i), slugNumber(s) {}
+};
+
+// Colors are resolved against the palette when drawing so a theme change never touches the layout
+enum class ColorRole : uint8_t
+{
+	Text,
+	Slug,
+	Character
+};
+
+// One line of laid out text, built without touching SFML so it can be done off the main thread
+struct LayoutLine
+{
+	std::string text;
+	float y = 0.f;
+	ColorRole role = ColorRole::Text;
+	uint32_t characterIndex = 0;
+};
+
+struct Layout
+{
+	std::vector<LayoutLine> lines;
+	std::vector<SlugRegion> slugRegions;
+	std::vector<float> slugScrollPositions;
+	float height = 0.f;
+};
+
+// Glyph extents below the baseline for the current font size, enough to measure a line like sf::Text does
+struct LineMetrics
+{
+	uint32_t fontSize = 0;
+	std::array<float, 256> glyphBottom{};
+
+	float LineHeight(const std::string& text, bool hasOutline) const;
+};
+
+// Wraps and positions a sequence, nothing here needs a window or a font
+class LayoutBuilder
+{
+public:
+	Layout Build(const Sequence& seq, const CharacterCollection& chars, const LineMetrics& metrics) const;
+
+	std::vector<std::string> DialogueLineBreaks(const std::string& line) const;
+	std::vector<std::string> ParentheticalLineBreaks(const std::string& line) const;
+	std::vector<std::string> ActionLineBreaks(const std::string& line) const;
+	std::string SlugFormat(const uint32_t number, const std::string& line) const;
+
+private:
+	const int k_dialogueLimit = 36;
+	const int k_parentheticalLimit = 31;
+	const int k_actionLimit = 57;
+	const int k_actionTabs = 1;
+	const int k_characterTabs = 5;
+	const int k_parenthTabs = 4;
+	const int k_dialogueTabs = 3;
+};
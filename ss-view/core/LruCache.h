@@ -0,0 +1,78 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// Thread safe least-recently-used cache. Values are shared so an evicted entry stays alive while it is in use.
+template <typename Key, typename Value>
+class LruCache
+{
+public:
+	void SetCapacity(size_t capacity)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_capacity = capacity;
+		Trim();
+	}
+
+	std::shared_ptr<const Value> Find(const Key& key)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+		{
+			if (it->first == key)
+			{
+				m_entries.splice(m_entries.begin(), m_entries, it);
+				return m_entries.front().second;
+			}
+		}
+		return nullptr;
+	}
+
+	bool Contains(const Key& key)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const auto& entry : m_entries)
+		{
+			if (entry.first == key)
+				return true;
+		}
+		return false;
+	}
+
+	void Insert(const Key& key, std::shared_ptr<const Value> value)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+		{
+			if (it->first == key)
+			{
+				m_entries.erase(it);
+				break;
+			}
+		}
+		m_entries.emplace_front(key, std::move(value));
+		Trim();
+	}
+
+	void Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries.clear();
+	}
+
+private:
+	void Trim()
+	{
+		while (m_entries.size() > m_capacity)
+		{
+			m_entries.pop_back();
+		}
+	}
+
+	std::list<std::pair<Key, std::shared_ptr<const Value>>> m_entries;
+	std::mutex m_mutex;
+	size_t m_capacity = 8;
+};
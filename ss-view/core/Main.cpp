@@ -11,8 +11,13 @@
 
 #include <filesystem>
 
+#include "AllocStats.h"
 #include "FileChecker.h"
+#include "FontManager.h"
 #include "Formatter.h"
+#include "FrameCounter.h"
+#include "ProcessLauncher.h"
+#include "Profiler.h"
 #include "Project.h"
 #include "Scrollbar.h"
 #include "Settings.h"
@@ -25,18 +30,39 @@ bool g_darkMode = true;
 
 int main(int argc, char** argv)
 {
-    if (argc > 1)
+    std::string tracePath;
+    bool printAllocStats = false;
+    for (int i = 1; i < argc; ++i)
     {
-        if (strcmp(argv[1], "--help") == 0)
+        if (strcmp(argv[i], "--help") == 0)
         {
-            std::cout << "SimpleScript - Viewer\n  Run in SimpleScript project root directory.\n\n  Shortcuts\n    Ctrl+Left/Right -- Move to next/prev squence\n    Ctrl+M -- Switch dark/light mode\n    Double-click -- Open contents under cursor in notepad\n\n";
+            std::cout << "SimpleScript - Viewer\n  Run in SimpleScript project root directory.\n\n  Options\n    --trace=path -- Record timings and write them as a Chrome trace on exit\n    --alloc-stats -- Print allocations per phase (load, wrap, layout) on exit\n\n  Shortcuts\n    Ctrl+Left/Right -- Move to next/prev squence\n    Ctrl+M -- Switch dark/light mode\n    Ctrl+A -- Show all sequences as one continuous script\n    Ctrl+F -- Show frames rendered per second and glyph atlas memory\n    F3 -- Show timings\n    Double-click -- Open contents under cursor in the editor (editorCommand in view.ini)\n\n";
+            return 0;
+        }
+        if (strncmp(argv[i], "--trace=", 8) == 0)
+        {
+            tracePath = argv[i] + 8;
+            Profiler::Get().SetEnabled(true);
+        }
+        else if (strcmp(argv[i], "--alloc-stats") == 0)
+        {
+            printAllocStats = true;
+            if (!AllocStats::IsCompiledIn())
+            {
+                std::cout << "--alloc-stats -- this build does not count allocations, regenerate with 'premake5 --alloc-stats'" << std::endl;
+            }
+        }
+        else
+        {
+            std::cout << argv[i] << " -- was not a recognized option" << std::endl;
+            return 0;
         }
-        return 0;
     }
 
     Settings::Get().Load();
 
     sf::RenderWindow window(sf::VideoMode(800, 1080), "SimpleScript - Viewer");
+    window.setVerticalSyncEnabled(true);
 
     BOOL useDark = TRUE;
     DwmSetWindowAttribute(window.getSystemHandle(), DWMWA_USE_IMMERSIVE_DARK_MODE, &useDark, sizeof(useDark));
@@ -56,17 +82,17 @@ int main(int argc, char** argv)
 
     Project proj;
 #ifdef _DEBUG
-    proj.Load(std::filesystem::current_path() / "prj");
+    proj.Load(std::filesystem::current_path() / "prj", true);
 #else
-    proj.Load(std::filesystem::current_path());
+    proj.Load(std::filesystem::current_path(), true);
 #endif // _DEBUG
     size_t sequenceIndex = 0;
 
-    window.setTitle("SimpleScript Viewer - " + proj.GetSequence(sequenceIndex).name + " (" + std::to_string(sequenceIndex + 1) + "/" + std::to_string(proj.GetNumberOfSequences()) + ")");
+    window.setTitle("SimpleScript Viewer - " + proj.GetSequenceName(sequenceIndex) + " (" + std::to_string(sequenceIndex + 1) + "/" + std::to_string(proj.GetNumberOfSequences()) + ")");
 
     Formatter formatter;
     formatter.SetFontSize(WindowMeasure(window.getSize().x));
-    formatter.LoadFromSequence(proj.GetSequence(sequenceIndex), proj.Characters(), g_darkMode);
+    formatter.LoadFromProject(proj, sequenceIndex, g_darkMode);
     mainScrollbar.SetIsVisible(formatter.GetContentSize() > window.getSize().y);
 
     Toolbar toolbar;
@@ -79,7 +105,7 @@ int main(int argc, char** argv)
     toolbar.SetHighlightColor({ 35,35, 35, 180 });
     for (size_t i = 0; i < proj.GetNumberOfSequences(); ++i)
     {
-        toolbar.AddMenuItem(std::to_string(i + 1) + " : " + proj.GetSequence(i).name);
+        toolbar.AddMenuItem(std::to_string(i + 1) + " : " + proj.GetSequenceName(i));
     }
     toolbar.Format();
     toolbar.SetIndexToBold(0);
@@ -94,16 +120,52 @@ int main(int argc, char** argv)
     FileChecker fileChecker;
     fileChecker.CheckFiles();
 
+    ProcessLauncher launcher;
+
     sf::Vector2f mousePositionLast;
     sf::Vector2f mouseDelta;
 
     sf::Clock clickTimer;
     bool doDoubleClick = false;
 
+    FrameCounter frameCounter;
+    bool showFrameRate = false;
+    sf::Text frameRateText;
+    frameRateText.setFont(formatter.GetFont());
+    frameRateText.setCharacterSize(14);
+    frameRateText.setFillColor({ 127, 127, 127 });
+
+    bool showProfiler = false;
+    sf::Text profilerText;
+    profilerText.setFont(formatter.GetFont());
+    profilerText.setCharacterSize(14);
+    profilerText.setFillColor(sf::Color::White);
+    profilerText.setPosition({ 20.f, 20.f });
+    sf::RectangleShape profilerBackground;
+    profilerBackground.setFillColor({ 0, 0, 0, 200 });
+    profilerBackground.setPosition({ 10.f, 10.f });
+
+    // Only redraw when something visible changed
+    bool isDirty = true;
+    bool wasOverToolbar = false;
+
     while (window.isOpen())
     {
+        if (!isDirty)
+        {
+            // Sleep until there is input, waking up only for the timers that still need servicing
+            DWORD timeout = INFINITE;
+            if (doDoubleClick)
+                timeout = (DWORD)((std::max)(DCLICK_TIME - clickTimer.getElapsedTime().asSeconds(), 0.f) * 1000.f) + 1;
+            if (showFrameRate || showProfiler)
+                timeout = (std::min)(timeout, (DWORD)(frameCounter.GetTimeToNextUpdate() * 1000.f) + 1);
+
+            MsgWaitForMultipleObjectsEx(0, nullptr, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+        }
+
         bool clickWasPressed = false;
         bool clickWasReleased = false;
+        bool didScroll = false;
 
         sf::Event event;
         while (window.pollEvent(event))
@@ -113,13 +175,17 @@ int main(int argc, char** argv)
 
             if (event.type == sf::Event::Resized)
             {
+                isDirty = true;
                 window.setView(sf::View({ (float)event.size.width * 0.5f, (float)event.size.height * 0.5f}, { (float)event.size.width, (float)event.size.height }));
                 mainScrollbar.SetWindowDimensions((sf::Vector2f)window.getSize());
                 mainScrollbar.SetIsVisible(formatter.GetContentSize() > window.getSize().y);
 
 
                 formatter.SetFontSize(WindowMeasure(window.getSize().x));
-                formatter.LoadFromSequence(proj.GetSequence(sequenceIndex), proj.Characters(), g_darkMode);
+                if (formatter.IsContinuous())
+                    formatter.LoadContinuous(proj, sequenceIndex, g_darkMode, window.getSize().y);
+                else
+                    formatter.LoadFromProject(proj, sequenceIndex, g_darkMode);
                 toolbar.SetMenuSize(window.getSize(), 300);
                 toolbar.SetTextProperties(formatter.GetFont());
                 toolbar.Format();
@@ -142,6 +208,7 @@ int main(int argc, char** argv)
 
             if (event.type == sf::Event::MouseWheelScrolled)
             {
+                isDirty = true;
                 float t = 0.f;
                 if (toolbar.IsOpen())
                 {
@@ -152,6 +219,7 @@ int main(int argc, char** argv)
                 {
                     formatter.OnScroll(event.mouseWheelScroll.delta * 50.f, window.getSize().y, t);
                     mainScrollbar.SetScrollPoint(t);
+                    didScroll = true;
                 }
             }
 
@@ -168,41 +236,70 @@ int main(int argc, char** argv)
             {
                 if (event.type == sf::Event::KeyPressed)
                 {
+                    isDirty = true;
                     if (event.key.code == sf::Keyboard::Right && sequenceIndex < proj.GetNumberOfSequences() - 1)
                     {
                         ++sequenceIndex;
-                        window.setTitle("SimpleScript Viewer - " + proj.GetSequence(sequenceIndex).name + " (" + std::to_string(sequenceIndex + 1) + "/" + std::to_string(proj.GetNumberOfSequences()) + ")");
-                        formatter.LoadFromSequence(proj.GetSequence(sequenceIndex), proj.Characters(), g_darkMode);
+                        window.setTitle("SimpleScript Viewer - " + proj.GetSequenceName(sequenceIndex) + " (" + std::to_string(sequenceIndex + 1) + "/" + std::to_string(proj.GetNumberOfSequences()) + ")");
+                        if (formatter.IsContinuous())
+                            formatter.ScrollToSequence(sequenceIndex, window.getSize().y);
+                        else
+                            formatter.LoadFromProject(proj, sequenceIndex, g_darkMode);
                         mainScrollbar.SetIsVisible(formatter.GetContentSize() > window.getSize().y);
-                        mainScrollbar.SetScrollPoint(0.f);
+                        mainScrollbar.SetScrollPoint(formatter.GetScrollFactor(window.getSize().y));
                         slugPositions.Calculate(formatter.GetSlugScrollPositions());
                     }
                     if (event.key.code == sf::Keyboard::Left && sequenceIndex > 0)
                     {
                         --sequenceIndex;
-                        window.setTitle("SimpleScript Viewer - " + proj.GetSequence(sequenceIndex).name + " (" + std::to_string(sequenceIndex + 1) + "/" + std::to_string(proj.GetNumberOfSequences()) + ")");
-                        formatter.LoadFromSequence(proj.GetSequence(sequenceIndex), proj.Characters(), g_darkMode);
+                        window.setTitle("SimpleScript Viewer - " + proj.GetSequenceName(sequenceIndex) + " (" + std::to_string(sequenceIndex + 1) + "/" + std::to_string(proj.GetNumberOfSequences()) + ")");
+                        if (formatter.IsContinuous())
+                            formatter.ScrollToSequence(sequenceIndex, window.getSize().y);
+                        else
+                            formatter.LoadFromProject(proj, sequenceIndex, g_darkMode);
                         mainScrollbar.SetIsVisible(formatter.GetContentSize() > window.getSize().y);
-                        mainScrollbar.SetScrollPoint(0.f);
+                        mainScrollbar.SetScrollPoint(formatter.GetScrollFactor(window.getSize().y));
                         slugPositions.Calculate(formatter.GetSlugScrollPositions());
                     }
                     if (event.key.code == sf::Keyboard::M)
                     {
                         g_darkMode = !g_darkMode;
-                        formatter.LoadFromSequence(proj.GetSequence(sequenceIndex), proj.Characters(), g_darkMode, true);
+                        formatter.SetDarkMode(g_darkMode);
+                    }
+                    if (event.key.code == sf::Keyboard::F)
+                    {
+                        showFrameRate = !showFrameRate;
+                    }
+                    if (event.key.code == sf::Keyboard::A)
+                    {
+                        if (formatter.IsContinuous())
+                            formatter.LoadFromProject(proj, sequenceIndex, g_darkMode);
+                        else
+                            formatter.LoadContinuous(proj, sequenceIndex, g_darkMode, window.getSize().y);
+                        mainScrollbar.SetIsVisible(formatter.GetContentSize() > window.getSize().y);
+                        mainScrollbar.SetScrollPoint(formatter.GetScrollFactor(window.getSize().y));
                         slugPositions.Calculate(formatter.GetSlugScrollPositions());
                     }
                 }
             }
 
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3)
+            {
+                showProfiler = !showProfiler;
+                Profiler::Get().SetEnabled(showProfiler || !tracePath.empty());
+                isDirty = true;
+            }
+
             if (event.type == sf::Event::GainedFocus)
             {
                 if (fileChecker.CheckFiles())
                 {
+                    isDirty = true;
+                    formatter.ClearCache();
 #ifdef _DEBUG
-                    proj.Load(std::filesystem::current_path() / "prj");
+                    proj.Load(std::filesystem::current_path() / "prj", true);
 #else
-                    proj.Load(std::filesystem::current_path());
+                    proj.Load(std::filesystem::current_path(), true);
 #endif // _DEBUG
                     bool resetScroll = false;
                     if (sequenceIndex >= proj.GetNumberOfSequences())
@@ -211,14 +308,23 @@ int main(int argc, char** argv)
                         resetScroll = true;
                     }
 
-                    formatter.LoadFromSequence(proj.GetSequence(sequenceIndex), proj.Characters(), g_darkMode, !resetScroll);
+                    if (formatter.IsContinuous())
+                    {
+                        formatter.LoadContinuous(proj, sequenceIndex, g_darkMode, window.getSize().y);
+                        if (!resetScroll)
+                            formatter.SetScroll(mainScrollbar.GetScrollFactor(), window.getSize().y);
+                    }
+                    else
+                    {
+                        formatter.LoadFromProject(proj, sequenceIndex, g_darkMode, !resetScroll);
+                    }
                     mainScrollbar.SetIsVisible(formatter.GetContentSize() > window.getSize().y);
                     slugPositions.Calculate(formatter.GetSlugScrollPositions());
 
                     toolbar.ClearMenuItems();
                     for (size_t i = 0; i < proj.GetNumberOfSequences(); ++i)
                     {
-                        toolbar.AddMenuItem(std::to_string(i + 1) + " : " + proj.GetSequence(i).name);
+                        toolbar.AddMenuItem(std::to_string(i + 1) + " : " + proj.GetSequenceName(i));
                     }
                     toolbar.Format();
                     toolbar.SetIndexToBold(sequenceIndex);
@@ -231,8 +337,21 @@ int main(int argc, char** argv)
         mouseDelta = (sf::Vector2f)mousePos - mousePositionLast;
         mousePositionLast = (sf::Vector2f)mousePos;
 
-        if (toolbar.CheckPoint(mousePositionLast))
+        int lastHighlightIndex = toolbar.GetHighlightIndex();
+        bool isOverToolbar = toolbar.CheckPoint(mousePositionLast);
+        if (isOverToolbar != wasOverToolbar || toolbar.GetHighlightIndex() != lastHighlightIndex)
         {
+            isDirty = true;
+        }
+        wasOverToolbar = isOverToolbar;
+
+        if (isOverToolbar)
+        {
+            if (clickWasPressed)
+            {
+                isDirty = true;
+            }
+
             if (!toolbar.IsOpen() && clickWasPressed)
             {
                 toolbar.SetIsOpen(true);
@@ -243,10 +362,13 @@ int main(int argc, char** argv)
                 if (index >= 0 && index != sequenceIndex)
                 {
                     sequenceIndex = index;
-                    window.setTitle("SimpleScript Viewer - " + proj.GetSequence(sequenceIndex).name + " (" + std::to_string(sequenceIndex + 1) + "/" + std::to_string(proj.GetNumberOfSequences()) + ")");
-                    formatter.LoadFromSequence(proj.GetSequence(sequenceIndex), proj.Characters(), g_darkMode);
+                    window.setTitle("SimpleScript Viewer - " + proj.GetSequenceName(sequenceIndex) + " (" + std::to_string(sequenceIndex + 1) + "/" + std::to_string(proj.GetNumberOfSequences()) + ")");
+                    if (formatter.IsContinuous())
+                        formatter.ScrollToSequence(sequenceIndex, window.getSize().y);
+                    else
+                        formatter.LoadFromProject(proj, sequenceIndex, g_darkMode);
                     mainScrollbar.SetIsVisible(formatter.GetContentSize() > window.getSize().y);
-                    mainScrollbar.SetScrollPoint(0.f);
+                    mainScrollbar.SetScrollPoint(formatter.GetScrollFactor(window.getSize().y));
                     slugPositions.Calculate(formatter.GetSlugScrollPositions());
                     toolbar.SetIsOpen(false);
                     toolbar.SetIndexToBold(sequenceIndex);
@@ -256,6 +378,7 @@ int main(int argc, char** argv)
         else if (clickWasPressed && toolbar.IsOpen())
         {
             toolbar.SetIsOpen(false);
+            isDirty = true;
         }
 
         if (toolbar.IsOpen())
@@ -269,6 +392,7 @@ int main(int argc, char** argv)
             {
                 toolbarScrollbar.DoScroll(mouseDelta);
                 toolbar.SetScroll(toolbarScrollbar.GetScrollFactor());
+                isDirty = true;
             }
         }
         if (clickWasReleased && toolbarScrollbar.GetIsDragging())
@@ -289,6 +413,16 @@ int main(int argc, char** argv)
         {
             mainScrollbar.DoScroll(mouseDelta);
             formatter.SetScroll(mainScrollbar.GetScrollFactor(), window.getSize().y);
+            isDirty = true;
+            didScroll = true;
+        }
+
+        // In the continuous view the current sequence follows the scroll position
+        if (didScroll && formatter.IsContinuous() && formatter.GetSequenceAtScroll() != sequenceIndex)
+        {
+            sequenceIndex = formatter.GetSequenceAtScroll();
+            window.setTitle("SimpleScript Viewer - " + proj.GetSequenceName(sequenceIndex) + " (" + std::to_string(sequenceIndex + 1) + "/" + std::to_string(proj.GetNumberOfSequences()) + ")");
+            toolbar.SetIndexToBold(sequenceIndex);
         }
 
         if (clickWasPressed)
@@ -306,7 +440,7 @@ int main(int argc, char** argv)
                     //DO Double click stuff
                     if (!toolbar.IsOpen())
                     {
-                        formatter.TryOpenFile(mousePositionLast, proj);
+                        formatter.TryOpenFile(mousePositionLast, proj, launcher);
                     }
                 }
             }
@@ -316,6 +450,17 @@ int main(int argc, char** argv)
             doDoubleClick = false;
         }
 
+        if (frameCounter.Update() && (showFrameRate || showProfiler))
+        {
+            isDirty = true;
+        }
+
+        if (!isDirty)
+            continue;
+        isDirty = false;
+
+        PROFILE_SCOPE("Main::Render");
+
         window.clear((g_darkMode) ? sf::Color(20, 20, 20) : sf::Color(235, 235, 235));
         formatter.DrawTo(window);
         if (mainScrollbar.GetIsVisible())
@@ -328,7 +473,39 @@ int main(int argc, char** argv)
         {
             toolbarScrollbar.DrawTo(window);
         }
+        if (showFrameRate)
+        {
+            frameRateText.setString(std::to_string(frameCounter.GetFramesPerSecond()) + " fps - glyph atlas "
+                + std::to_string(FontManager::Get().GetAtlasMemory() / 1024) + " KB");
+            frameRateText.setPosition({ 10.f, (float)window.getSize().y - 24.f });
+            window.draw(frameRateText);
+        }
+        if (showProfiler)
+        {
+            std::string summary = "Timer                       avg ms   max ms   count\n";
+            for (const Profiler::Summary& timer : Profiler::Get().Summarize())
+            {
+                char line[128];
+                snprintf(line, sizeof(line), "%-27s %7.2f  %7.2f  %6zu\n", timer.name, timer.averageMs, timer.maxMs, timer.count);
+                summary += line;
+            }
+            profilerText.setString(summary);
+            profilerBackground.setSize({ profilerText.getLocalBounds().width + 20.f, profilerText.getLocalBounds().height + 20.f });
+            window.draw(profilerBackground);
+            window.draw(profilerText);
+        }
         window.display();
+        frameCounter.OnFrame();
+    }
+
+    if (!tracePath.empty() && !Profiler::Get().WriteTrace(tracePath))
+    {
+        std::cout << "Could not write trace to " << tracePath << std::endl;
+    }
+
+    if (printAllocStats && AllocStats::IsCompiledIn())
+    {
+        AllocStats::Get().Print(std::cout);
     }
 
     return 0;
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+// Runs shell commands on detached threads so the caller never waits for the process
+class ProcessLauncher
+{
+public:
+	// {file} in the command is replaced by the quoted path, otherwise the path is appended
+	void Open(const std::string& command, const std::string& file)
+	{
+		std::string path = file;
+		if (path.find_first_of('\"') == std::string::npos)
+			path = "\"" + path + "\"";
+
+		std::string cmd = command;
+		size_t placeholder = cmd.find(k_filePlaceholder);
+		if (placeholder == std::string::npos)
+			cmd += " " + path;
+		else
+			cmd.replace(placeholder, k_filePlaceholder.length(), path);
+
+		Launch(cmd);
+	}
+
+	void Launch(const std::string& command)
+	{
+		std::thread([command]()
+			{
+				std::system(command.c_str());
+			}).detach();
+	}
+
+private:
+	const std::string k_filePlaceholder = "{file}";
+};
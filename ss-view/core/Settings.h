@@ -22,6 +22,11 @@ public:
     Settings operator=(const Settings&& other) = delete;
 
     std::string fontPath = "C:/Windows/Fonts/CourierPrime-Regular.ttf";
+#ifdef _WIN32
+    std::string editorCommand = "start notepad {file}";
+#else
+    std::string editorCommand = "xdg-open {file}";
+#endif // _WIN32
 
     void Load()
     {
@@ -49,6 +54,11 @@ public:
                 std::getline(linestream, cell);
                 fontPath = cell;
             }
+            else if (cell == "editorCommand")
+            {
+                std::getline(linestream, cell);
+                editorCommand = cell;
+            }
             else
             {
                 std::cout << cell << " -- was not a recognized settings key" << std::endl;
@@ -64,5 +74,6 @@ public:
         std::ofstream file(_APPDATA_ + "\\SimpleScript\\view.ini");
 
         file << "fontPath=" << fontPath << std::endl;
+        file << "editorCommand=" << editorCommand << std::endl;
     }
 };
@@ -11,35 +11,40 @@ public:
 	void SetLineSize(const sf::Vector2f size) { m_lineSize = size; }
 	void SetWindowSize(const sf::Vector2f& windowSize) { m_windowSize = windowSize; }
 
+	// Builds every marker into one vertex array so they are drawn in a single call
 	void Calculate(const std::vector<float>& scrollPositions)
 	{
-		m_visuals.resize(scrollPositions.size());
-		m_scrollPositions = scrollPositions;
+		m_vertices.clear();
+		m_vertices.setPrimitiveType(sf::Triangles);
+		m_vertices.resize(scrollPositions.size() * 6);
 
-		for (size_t i = 0; i < m_visuals.size(); ++i)
+		for (size_t i = 0; i < scrollPositions.size(); ++i)
 		{
-			sf::RectangleShape& rect = m_visuals[i];
-			rect.setSize(m_lineSize);
-			rect.setFillColor(m_color);
-			rect.setPosition(sf::Vector2f(
-				m_windowSize.x - m_lineSize.x,
-				scrollPositions[i] * m_windowSize.y
-			));
+			sf::Vector2f topLeft(m_windowSize.x - m_lineSize.x, scrollPositions[i] * m_windowSize.y);
+			sf::Vector2f bottomRight = topLeft + m_lineSize;
+
+			sf::Vertex* quad = &m_vertices[i * 6];
+			quad[0].position = topLeft;
+			quad[1].position = { bottomRight.x, topLeft.y };
+			quad[2].position = { topLeft.x, bottomRight.y };
+			quad[3].position = { topLeft.x, bottomRight.y };
+			quad[4].position = { bottomRight.x, topLeft.y };
+			quad[5].position = bottomRight;
+			for (size_t v = 0; v < 6; ++v)
+			{
+				quad[v].color = m_color;
+			}
 		}
 	}
 
 	void DrawTo(sf::RenderTarget& target)
 	{
-		for (const sf::RectangleShape& rect : m_visuals)
-		{
-			target.draw(rect);
-		}
+		target.draw(m_vertices);
 	}
 
 private:
-	std::vector<float> m_scrollPositions;
-	std::vector<sf::RectangleShape> m_visuals;
+	sf::VertexArray m_vertices;
 	sf::Vector2f m_windowSize;
 	sf::Vector2f m_lineSize;
 	sf::Color m_color;
-};
\ No newline at end of file
+};
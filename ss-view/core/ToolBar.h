@@ -30,6 +30,7 @@ public:
 		m_renderTexture.create(menuWidth, windowSize.y);
 		m_renderSprite.setTexture(m_renderTexture.getTexture(), true);
 		m_background.setSize((sf::Vector2f)windowSize);
+		m_isMenuDirty = true;
 	}
 	
 	void SetBackgroundColor(const sf::Color& color)
@@ -40,6 +41,7 @@ public:
 	void SetClearColor(const sf::Color& color)
 	{
 		m_clearColor = color;
+		m_isMenuDirty = true;
 	}
 
 	void SetIconColor(const sf::Color& color)
@@ -65,6 +67,7 @@ public:
 	void SetIsOpen(const bool isOpen)
 	{
 		m_isOpen = isOpen;
+		m_isMenuDirty = true;
 	}
 
 	void SetTextProperties(const sf::Font& font)
@@ -76,6 +79,7 @@ public:
 	{
 		m_highlight.setFillColor(color);
 		m_highlight.setSize({ (float)m_renderTexture.getSize().x, (float)m_textSize * 1.5f });
+		m_isMenuDirty = true;
 	}
 
 	void AddMenuItem(const std::string& name)
@@ -90,23 +94,36 @@ public:
 		item.setFillColor(sf::Color::White);
 		item.setFont(*m_font);
 		item.setCharacterSize(m_textSize);
+		m_isMenuDirty = true;
 
-		for (size_t i = 1; i <= name.length(); ++i)
+		// Binary search for the shortest prefix that overflows, prefix width only grows with length
+		const float limit = (float)m_renderTexture.getSize().x - m_textSize;
+		size_t low = 1;
+		size_t high = name.length() + 1; // name.length() + 1 -> nothing overflows
+		while (low < high)
 		{
-			std::string substr = name.substr(0, i);
-			item.setString(name.substr(0, i));
-			if (item.getLocalBounds().width + item.getLocalBounds().left > (m_renderTexture.getSize().x - m_textSize))
-			{
-				size_t length = (size_t)std::max((int)i - 6, 1);
-				item.setString(name.substr(0, length) + "...");
-				break;
-			}
+			size_t mid = low + (high - low) / 2;
+			item.setString(name.substr(0, mid));
+			if (item.getLocalBounds().width + item.getLocalBounds().left > limit)
+				high = mid;
+			else
+				low = mid + 1;
 		}
+
+		if (low > name.length())
+		{
+			item.setString(name);
+			return;
+		}
+
+		size_t length = (size_t)std::max((int)low - 6, 1);
+		item.setString(name.substr(0, length) + "...");
 	}
 
 	void ClearMenuItems()
 	{
 		m_menuItems.clear();
+		m_isMenuDirty = true;
 	}
 
 	void Format()
@@ -119,6 +136,7 @@ public:
 			cursor += item.getLocalBounds().height + item.getLocalBounds().top + m_textSize * 0.5f;
 		}
 		m_scrollMax = cursor;
+		m_isMenuDirty = true;
 	}
 
 	void OnScroll(float delta, float& out_t)
@@ -136,6 +154,7 @@ public:
 			item.setPosition({ (float)m_textSize, cursor });
 			cursor += item.getLocalBounds().height + item.getLocalBounds().top + m_textSize * 0.5f;
 		}
+		m_isMenuDirty = true;
 
 		out_t = m_scrollOffset / (m_scrollMax - m_renderTexture.getSize().y + m_textSize);
 	}
@@ -150,6 +169,7 @@ public:
 			item.setPosition({ (float)m_textSize, cursor });
 			cursor += item.getLocalBounds().height + item.getLocalBounds().top + m_textSize * 0.5f;
 		}
+		m_isMenuDirty = true;
 	}
 
 	bool IsOpen() const { return m_isOpen; }
@@ -174,6 +194,7 @@ public:
 			m_menuItems[i].setFillColor({200, 200, 200});
 			m_menuItems[i].setOutlineThickness(0.f);
 		}
+		m_isMenuDirty = true;
 	}
 
 	void DrawTo(sf::RenderTarget& target)
@@ -181,23 +202,10 @@ public:
 		if (m_isOpen)
 		{
 			target.draw(m_background);
-			m_renderTexture.clear(m_clearColor);
-
-			if (m_highlightIndex >= 0)
-			{
-				m_highlight.setPosition({ 0.f,
-					m_menuItems[m_highlightIndex].getGlobalBounds().top
-					- m_textSize * 0.5f
-				});
-				m_renderTexture.draw(m_highlight);
-			}
-
-			for (sf::Text& item : m_menuItems)
+			if (m_isMenuDirty)
 			{
-				m_renderTexture.draw(item);
+				RenderMenu();
 			}
-
-			m_renderTexture.display();
 			target.draw(m_renderSprite);
 
 			return;
@@ -206,6 +214,36 @@ public:
 	}
 
 private:
+	void RenderMenu()
+	{
+		m_renderTexture.clear(m_clearColor);
+
+		if (m_highlightIndex >= 0)
+		{
+			m_highlight.setPosition({ 0.f,
+				m_menuItems[m_highlightIndex].getGlobalBounds().top
+				- m_textSize * 0.5f
+			});
+			m_renderTexture.draw(m_highlight);
+		}
+
+		for (sf::Text& item : m_menuItems)
+		{
+			m_renderTexture.draw(item);
+		}
+
+		m_renderTexture.display();
+		m_isMenuDirty = false;
+	}
+
+	void SetHighlightIndex(int index)
+	{
+		if (index == m_highlightIndex)
+			return;
+
+		m_highlightIndex = index;
+		m_isMenuDirty = true;
+	}
 
 	bool CheckPointClosed(const sf::Vector2f& point)
 	{
@@ -233,15 +271,15 @@ private:
 			{
 				if (CheckPointMenuItem(point, m_menuItems[i]))
 				{
-					m_highlightIndex = (int)i;
+					SetHighlightIndex((int)i);
 					return true;
 				}
 			}
-			m_highlightIndex = -1;
+			SetHighlightIndex(-1);
 			return true;
 		}
 
-		m_highlightIndex = -1;
+		SetHighlightIndex(-1);
 		return false;
 	}
 
@@ -257,6 +295,7 @@ private:
 	int m_highlightIndex = -1; // -1 == null
 	uint32_t m_textSize = 20;
 	float m_scrollMax = 0.f;
+	bool m_isMenuDirty = true;
 
 	const sf::Font* m_font;
 	sf::Color m_clearColor = sf::Color::Black;
@@ -1,23 +1,38 @@
 #pragma once
 
+#include "FontManager.h"
 #include "Settings.h"
 
 #include <SFML/Graphics.hpp>
 
 uint32_t WindowMeasure(uint32_t windowWidth)
 {
-	sf::Font font;
-	font.loadFromFile(Settings::Get().fontPath);
-
 	sf::Text text;
-	text.setFont(font);
+	text.setFont(FontManager::Get().GetFont(Settings::Get().fontPath));
 	text.setString("_________________________________________________________________");
-	uint32_t size = 1;
-	text.setCharacterSize(size);
-	while (text.getLocalBounds().width + text.getLocalBounds().left < windowWidth)
+
+	auto width = [&](uint32_t size)
+	{
+		text.setCharacterSize(size);
+		return text.getLocalBounds().width + text.getLocalBounds().left;
+	};
+
+	// Width grows linearly with the size, so only the sizes around the estimate have to be rendered
+	const uint32_t referenceSize = 100;
+	float referenceWidth = width(referenceSize);
+	if (referenceWidth <= 0.f)
+		return 0;
+
+	uint32_t size = std::max((uint32_t)(windowWidth * referenceSize / referenceWidth), 1u);
+
+	while (size > 0 && width(size) >= windowWidth)
+	{
+		--size;
+	}
+	while (width(size + 1) < windowWidth)
 	{
-		text.setCharacterSize(++size);
+		++size;
 	}
 
-	return size - 1;
-}
\ No newline at end of file
+	return size;
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define WORD_WRAP_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WORD_WRAP_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Greedy wrapping on single spaces, the break for a line is found from a space mask 32 bytes at a time
+// instead of walking the text word by word. Every line is a substring of the text so nothing is copied
+// until the caller wants a string.
+class WordWrap
+{
+public:
+	// Calls emit(begin, end) for every line, same lines as LineBreaksReference
+	template <typename Emit>
+	static void Wrap(std::string_view text, size_t limit, Emit&& emit)
+	{
+		const char* data = text.data();
+
+		// Splitting on ' ' never gives a word after a trailing space, so the last word ends there
+		size_t last = (!text.empty() && text.back() == ' ') ? text.size() - 1 : text.size();
+
+		size_t pos = 0;
+		while (true)
+		{
+			// Empty words only count once a line has something on it
+			while (pos < last && data[pos] == ' ')
+				++pos;
+
+			if (pos >= last)
+			{
+				emit(pos, pos);
+				return;
+			}
+
+			// A word that does not fit on its own pushes the empty line it started on
+			if (pos + limit <= last && FirstSpace(text, pos, pos + limit) == std::string_view::npos)
+				emit(pos, pos);
+
+			size_t lineStart = pos;
+			while (true)
+			{
+				// A word fits while it ends no more than 'limit' past the start of the line
+				size_t lineEnd = last;
+				if (lineStart + limit < last)
+				{
+					lineEnd = LastSpace(text, lineStart, lineStart + limit + 1);
+					if (lineEnd == std::string_view::npos)
+						lineEnd = std::min(FirstSpace(text, lineStart + limit + 1, last), last);
+				}
+
+				emit(lineStart, lineEnd);
+				if (lineEnd == last)
+					return;
+
+				// The word that did not fit starts the next line, unless it is empty
+				pos = lineEnd + 1;
+				if (pos == last || data[pos] == ' ')
+					break;
+
+				lineStart = pos;
+			}
+		}
+	}
+
+	static std::vector<std::string> LineBreaks(std::string_view text, size_t limit)
+	{
+		std::vector<std::string> result;
+		Wrap(text, limit, [&](size_t begin, size_t end) { result.emplace_back(text.substr(begin, end - begin)); });
+		return result;
+	}
+
+	// Word by word like the wrapping has always been done, kept as the reference LineBreaks is checked against
+	static std::vector<std::string> LineBreaksReference(std::string_view text, size_t limit)
+	{
+		std::vector<std::string> result;
+
+		size_t counter = 0;
+		std::string currLine;
+
+		size_t pos = 0;
+		while (pos < text.length())
+		{
+			size_t end = std::min(text.find(' ', pos), text.length());
+			std::string_view word = text.substr(pos, end - pos);
+			pos = end + 1;
+
+			counter += word.length();
+			if (counter + 1 > limit)
+			{
+				result.push_back(currLine);
+				counter = word.length();
+				currLine = word;
+				continue;
+			}
+			if (!currLine.empty())
+			{
+				currLine.push_back(' ');
+				++counter;
+			}
+			currLine.append(word);
+		}
+		result.push_back(currLine);
+
+		return result;
+	}
+
+	static const char* GetInstructionSet()
+	{
+#if defined(WORD_WRAP_AVX2)
+		return "AVX2";
+#elif defined(WORD_WRAP_SSE2)
+		return "SSE2";
+#else
+		return "scalar";
+#endif
+	}
+
+private:
+	// First space in [begin, end), npos if there is none
+	static size_t FirstSpace(std::string_view text, size_t begin, size_t end)
+	{
+		for (; begin < end; begin += 32)
+		{
+			uint32_t spaces = Spaces(text, begin, std::min(begin + 32, end));
+			if (spaces != 0)
+				return begin + LowestBit(spaces);
+		}
+		return std::string_view::npos;
+	}
+
+	// Last space in [begin, end), npos if there is none
+	static size_t LastSpace(std::string_view text, size_t begin, size_t end)
+	{
+		while (end > begin)
+		{
+			size_t start = (end - begin > 32) ? end - 32 : begin;
+			uint32_t spaces = Spaces(text, start, end);
+			if (spaces != 0)
+				return start + HighestBit(spaces);
+
+			end = start;
+		}
+		return std::string_view::npos;
+	}
+
+	// Bit i is set for a space at text[begin + i], at most 32 bytes
+	static uint32_t Spaces(std::string_view text, size_t begin, size_t end)
+	{
+		size_t count = end - begin;
+		if (count == 32)
+			return BlockMask(text.data() + begin);
+
+		// Short ranges load a full block around them when the text is long enough
+		if (end >= 32)
+			return BlockMask(text.data() + end - 32) >> (32 - count);
+		if (text.size() - begin >= 32)
+			return BlockMask(text.data() + begin) & ((1u << count) - 1);
+
+		char block[32] = {};
+		std::memcpy(block, text.data() + begin, count);
+		return BlockMask(block);
+	}
+
+	static uint32_t BlockMask(const char* block)
+	{
+#if defined(WORD_WRAP_AVX2)
+		__m256i bytes = _mm256_loadu_si256((const __m256i*)block);
+		return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')));
+#elif defined(WORD_WRAP_SSE2)
+		const __m128i space = _mm_set1_epi8(' ');
+		uint32_t low = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)block), space));
+		uint32_t high = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(block + 16)), space));
+		return low | (high << 16);
+#else
+		uint32_t mask = 0;
+		for (size_t i = 0; i < 32; ++i)
+		{
+			mask |= (uint32_t)(block[i] == ' ') << i;
+		}
+		return mask;
+#endif
+	}
+
+	static size_t LowestBit(uint32_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, bits);
+		return index;
+#else
+		return (size_t)__builtin_ctz(bits);
+#endif
+	}
+
+	static size_t HighestBit(uint32_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse(&index, bits);
+		return index;
+#else
+		return 31 - (size_t)__builtin_clz(bits);
+#endif
+	}
+};
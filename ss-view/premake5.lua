@@ -1,3 +1,9 @@
+newoption
+{
+    trigger = "alloc-stats",
+    description = "Count allocations per phase, printed with --alloc-stats"
+}
+
 workspace "ss-view"
 architecture "x64"
     configurations { "Debug", "Release" }
@@ -52,6 +58,9 @@ project "core"
 		systemversion "latest"
 		defines { "WIN32" }
 
+    filter "options:alloc-stats"
+        defines { "SS_ALLOC_STATS" }
+
 	filter "configurations:Debug"
 		defines { "_DEBUG", "_CONSOLE" }
 		symbols "On"
@@ -76,3 +85,52 @@ project "core"
             "sfml-window-s"
         }
 
+
+project "bench"
+    location "%{prj.name}"
+    kind "ConsoleApp"
+    language "C++"
+    targetname "%{prj.name}"
+    targetdir ("bin/".. outputdir)
+    objdir ("%{prj.name}/int/" .. outputdir)
+    cppdialect "C++17"
+    staticruntime "Off"
+
+    -- Only the headless layout code, the bench never opens a window
+    files
+    {
+        "%{prj.name}/**.h",
+        "%{prj.name}/**.cpp",
+        "core/LayoutBuilder.h",
+        "core/LayoutBuilder.cpp"
+    }
+
+    includedirs
+    {
+        "core",
+        "core/include",
+        "../ss-gen/core"
+    }
+
+    filter "system:windows"
+		systemversion "latest"
+		defines { "WIN32", "SFML_STATIC" }
+        libdirs "core/lib"
+        links { "opengl32", "winmm", "gdi32", "freetype" }
+
+    filter "system:linux"
+        links { "sfml-graphics", "sfml-system", "pthread" }
+
+	filter { "system:windows", "configurations:Debug" }
+        links { "sfml-graphics-s-d", "sfml-system-s-d" }
+
+	filter { "system:windows", "configurations:Release" }
+        links { "sfml-graphics-s", "sfml-system-s" }
+
+	filter "configurations:Debug"
+		defines { "_DEBUG", "_CONSOLE" }
+		symbols "On"
+
+    filter "configurations:Release"
+		defines { "NDEBUG", "_CONSOLE" }
+		optimize "On"